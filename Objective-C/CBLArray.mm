@@ -123,11 +123,10 @@ static const MValue<id>& _get(MArray<id> &array, NSUInteger index) {
 }
 
 static id _getObject(MArray<id> &array, NSUInteger index, Class asClass =nil) {
-    //OPT: Can return nil before calling asNative, if MValue.value exists and is wrong type
-    id obj = _get(array, index).asNative(&array);
-    if (asClass && ![obj isKindOfClass: asClass])
-        obj = nil;
-    return obj;
+    auto &val = _get(array, index);
+    if (asClass)
+        return asObjectOfClass(val, array, asClass);
+    return val.asNative(&array);
 }
 
 - (nullable id) valueAtIndex: (NSUInteger)index {
@@ -138,13 +137,13 @@ static id _getObject(MArray<id> &array, NSUInteger index, Class asClass =nil) {
 
 - (nullable NSString*) stringAtIndex: (NSUInteger)index {
     CBL_LOCK(_sharedLock) {
-        return _getObject(_array, index, [NSString class]);
+        return asString(_get(_array, index), _array);
     }
 }
 
 - (nullable NSNumber*) numberAtIndex: (NSUInteger)index {
     CBL_LOCK(_sharedLock) {
-        return _getObject(_array, index, [NSNumber class]);
+        return asNumber(_get(_array, index), _array);
     }
 }
 
@@ -180,7 +179,7 @@ static id _getObject(MArray<id> &array, NSUInteger index, Class asClass =nil) {
 
 - (nullable NSDate*) dateAtIndex: (NSUInteger)index {
     CBL_LOCK(_sharedLock) {
-        return asDate(_getObject(_array, index));
+        return asDate(_get(_array, index), _array);
     }
 }
 
@@ -24,6 +24,7 @@
 @class CBLDocument;
 @class CBLDocumentChange;
 @class CBLMutableDocument;
+@class CBLQueryExpression;
 @class CBLScope;
 @protocol CBLListenerToken;
 
@@ -89,6 +90,38 @@ extern NSString* const kCBLDefaultCollectionName;
  */
 - (nullable CBLDocument*) documentWithID: (NSString*)documentID error: (NSError**)error;
 
+/**
+ Gets an existing document with the given ID, reading only its metadata. The document's
+ revisionID, sequence and deletion status are available right away, while its properties are read
+ from the database the first time they're accessed. This is cheaper than documentWithID:error:
+ when the properties may not be needed. If the document doesn't exist, the value returned will
+ be nil.
+ 
+ @note If the revision is replaced and compacted away before the properties are accessed,
+ the document will appear to be empty.
+ 
+ @param documentID The document ID.
+ @param error On return, the error if any.
+ @return The CBLDocument object.
+ */
+- (nullable CBLDocument*) documentMetadataWithID: (NSString*)documentID
+                                           error: (NSError**)error;
+
+/**
+ Gets the existing documents with the given IDs. All of the documents are read while holding
+ the database lock once, in much less time than fetching them one by one. This doesn't block
+ other connections from writing, so a document can change while the batch is being read.
+ Documents that don't exist are skipped; the others are returned in the same order as their
+ IDs. An ID that appears more than once is only looked up once, and the same document object is
+ returned at each of its positions.
+ 
+ @param documentIDs The document IDs.
+ @param error On return, the error if any.
+ @return The CBLDocument objects.
+ */
+- (nullable NSArray<CBLDocument*>*) documentsWithIDs: (NSArray<NSString*>*)documentIDs
+                                               error: (NSError**)error;
+
 #pragma mark - Save, Delete, Purge
 
 /**
@@ -195,6 +228,32 @@ extern NSString* const kCBLDefaultCollectionName;
  */
 - (BOOL) purgeDocumentWithID: (NSString*)documentID error: (NSError**)error;
 
+/**
+ Purge the documents with the given IDs from the collection. All of the documents are purged in
+ a single transaction, which is much faster than purging them one by one. IDs of documents that
+ don't exist in the collection are skipped. If any other error occurs, none of the documents
+ are purged.
+ 
+ @param documentIDs The IDs of the documents to be purged.
+ @param error On return, the error if any.
+ @return The IDs of the documents that were purged, or nil on failure.
+ */
+- (nullable NSSet<NSString*>*) purgeDocumentsWithIDs: (NSArray<NSString*>*)documentIDs
+                                               error: (NSError**)error;
+
+/**
+ Purge the documents in the collection that match the given predicate, e.g.
+ `[[CBLQueryExpression property: @"type"] equalTo: [CBLQueryExpression string: @"stale"]]`.
+ The matching documents are found with a query on this collection, and are purged as with
+ purgeDocumentsWithIDs:error:.
+ 
+ @param predicate The WHERE expression that the documents to be purged match.
+ @param error On return, the error if any.
+ @return The IDs of the documents that were purged, or nil on failure.
+ */
+- (nullable NSSet<NSString*>*) purgeDocumentsWhere: (CBLQueryExpression*)predicate
+                                             error: (NSError**)error;
+
 #pragma mark - DOCUMENT EXPIRATION
 
 /**
@@ -210,6 +269,20 @@ extern NSString* const kCBLDefaultCollectionName;
                           expiration: (nullable NSDate*)date
                                error: (NSError**)error;
 
+/**
+ Set an expiration date to the documents of the given ids, in a single transaction.
+ Setting a nil date will clear the expiration. IDs of documents that don't exist in the
+ collection are skipped. If any other error occurs, none of the expiration dates are changed.
+ 
+ @param documentIDs The IDs of the documents to set the expiration date for
+ @param date The expiration date. Set nil date will reset the document expiration.
+ @param error On return, the error if any.
+ @return The IDs of the documents whose expiration date was set, or nil on failure.
+ */
+- (nullable NSSet<NSString*>*) setDocumentExpirationForIDs: (NSArray<NSString*>*)documentIDs
+                                                expiration: (nullable NSDate*)date
+                                                     error: (NSError**)error;
+
 /**
  Get the expiration date set to the document of the given id.
  
@@ -30,10 +30,18 @@
 #import "CBLErrorMessage.h"
 #import "CBLIndexable.h"
 #import "CBLIndexConfiguration+Internal.h"
+#import "CBLQueryBuilder.h"
+#import "CBLQueryDataSource.h"
+#import "CBLQueryMeta.h"
+#import "CBLQueryResult.h"
+#import "CBLQueryResultSet.h"
+#import "CBLQuerySelectResult.h"
 #import "CBLScope.h"
 #import "CBLScope+Internal.h"
 #import "CBLStatus.h"
 #import "CBLStringBytes.h"
+#import "CBLTrace.hh"
+#import <vector>
 
 #define msec 1000.0
 
@@ -207,6 +215,79 @@ NSString* const kCBLDefaultCollectionName = @"_default";
     }
 }
 
+- (CBLDocument*) documentMetadataWithID: (NSString*)documentID error: (NSError**)error {
+    CBLAssertNotNil(documentID);
+    
+    CBL_LOCK(_mutex) {
+        if (![self collectionIsValid: error])
+            return nil;
+        
+        return [[CBLDocument alloc] initWithCollection: self
+                                            documentID: documentID
+                                        includeDeleted: NO
+                                          contentLevel: kDocGetMetadata
+                                                 error: error];
+    }
+}
+
+- (NSArray<CBLDocument*>*) documentsWithIDs: (NSArray<NSString*>*)documentIDs
+                                      error: (NSError**)error {
+    CBLAssertNotNil(documentIDs);
+    
+    // Look up each ID once, in sorted order, so consecutive lookups hit neighboring pages of
+    // the b-tree. (NSLiteralSearch compares UTF-16 code units, which is close enough to the
+    // UTF-8 byte order of the keys.)
+    NSArray<NSString*>* sortedIDs = [[NSSet setWithArray: documentIDs].allObjects
+                                     sortedArrayUsingComparator: ^NSComparisonResult(NSString* a,
+                                                                                     NSString* b) {
+        return [a compare: b options: NSLiteralSearch];
+    }];
+    
+    NSMutableDictionary<NSString*, CBLDocument*>* found =
+        [NSMutableDictionary dictionaryWithCapacity: sortedIDs.count];
+    
+    CBL_LOCK(_mutex) {
+        if (![self collectionIsValid: error])
+            return nil;
+        
+        CBLDatabase* db = _db;
+        if (![self database: db isValid: error])
+            return nil;
+        
+        // These are plain reads under the database lock. LiteCore has no read-only transaction,
+        // and a write transaction would keep the replicator and other connections from writing
+        // while the batch is read.
+        CBLStringBytes docID;
+        for (NSString* documentID in sortedIDs) {
+            docID = documentID;
+            C4Error err = {};
+            C4Document* doc = c4coll_getDoc(_c4col, docID, true, kDocGetCurrentRev, &err);
+            if (!doc) {
+                if (err.domain == LiteCoreDomain && err.code == kC4ErrorNotFound)
+                    continue;
+                convertError(err, error);
+                return nil;
+            }
+            if ((doc->flags & kDocDeleted) != 0) {
+                c4doc_release(doc);
+                continue;
+            }
+            found[documentID] = [[CBLDocument alloc] initWithCollection: self
+                                                             documentID: documentID
+                                                                  c4Doc: [CBLC4Document document: doc]];
+        }
+    }
+    
+    // Return the documents in the caller's order; a repeated ID gets the same document object:
+    NSMutableArray<CBLDocument*>* docs = [NSMutableArray arrayWithCapacity: found.count];
+    for (NSString* documentID in documentIDs) {
+        CBLDocument* doc = found[documentID];
+        if (doc)
+            [docs addObject: doc];
+    }
+    return docs;
+}
+
 #pragma mark - Purge
 
 - (BOOL) purgeDocument: (CBLDocument*)document
@@ -260,6 +341,81 @@ NSString* const kCBLDefaultCollectionName = @"_default";
     }
 }
 
+- (NSSet<NSString*>*) purgeDocumentsWithIDs: (NSArray<NSString*>*)documentIDs
+                                      error: (NSError**)error {
+    CBLAssertNotNil(documentIDs);
+    return [self forDocumentIDs: documentIDs error: error
+                         action: ^bool(C4Slice docID, C4Error* outErr) {
+        return c4coll_purgeDoc(_c4col, docID, outErr);
+    }];
+}
+
+- (NSSet<NSString*>*) purgeDocumentsWhere: (CBLQueryExpression*)predicate
+                                    error: (NSError**)error {
+    CBLAssertNotNil(predicate);
+    
+    // The query is built here so that neither its source nor its ID column can be chosen by
+    // the caller:
+    CBLQuerySelectResult* docID = [CBLQuerySelectResult expression: [CBLQueryMeta id]];
+    CBLQuery* query = [CBLQueryBuilder select: @[docID]
+                                         from: [CBLQueryDataSource collection: self]
+                                        where: predicate];
+    CBL_LOCK(_mutex) {
+        // Holding the database lock keeps other threads using this database from changing the
+        // documents between running the query and purging them.
+        CBLQueryResultSet* rs = [query execute: error];
+        if (!rs)
+            return nil;
+        
+        NSMutableArray<NSString*>* documentIDs = [NSMutableArray array];
+        for (CBLQueryResult* result in rs)
+            [documentIDs addObject: [result stringAtIndex: 0]];
+        return [self purgeDocumentsWithIDs: documentIDs error: error];
+    }
+}
+
+// Calls the action for each of the IDs inside a single transaction, and returns the IDs it
+// succeeded for. IDs of documents that don't exist are skipped; any other error rolls back the
+// whole transaction.
+- (nullable NSSet<NSString*>*) forDocumentIDs: (NSArray<NSString*>*)documentIDs
+                                        error: (NSError**)error
+                                       action: (bool (NS_NOESCAPE ^)(C4Slice, C4Error*))action
+{
+    CBL_LOCK(_mutex) {
+        if (![self collectionIsValid: error])
+            return nil;
+        
+        CBLDatabase* db = _db;
+        if (![self database: db isValid: error])
+            return nil;
+        
+        C4Transaction transaction(db.c4db);
+        if (!transaction.begin()) {
+            convertError(transaction.error(), error);
+            return nil;
+        }
+        
+        NSMutableSet<NSString*>* done = [NSMutableSet setWithCapacity: documentIDs.count];
+        CBLStringBytes docID;
+        for (NSString* documentID in documentIDs) {
+            docID = documentID;
+            C4Error err = {};
+            if (action(docID, &err)) {
+                [done addObject: documentID];
+            } else if (!(err.domain == LiteCoreDomain && err.code == kC4ErrorNotFound)) {
+                convertError(err, error);
+                return nil;
+            }
+        }
+        
+        if (!transaction.commit()) {
+            convertError(transaction.error(), error);
+            return nil;
+        }
+        return done;
+    }
+}
+
 #pragma mark - Delete Document
 
 - (BOOL) deleteDocument: (CBLDocument*)document
@@ -398,6 +554,18 @@ NSString* const kCBLDefaultCollectionName = @"_default";
     return NO;
 }
 
+- (NSSet<NSString*>*) setDocumentExpirationForIDs: (NSArray<NSString*>*)documentIDs
+                                       expiration: (NSDate*)date
+                                            error: (NSError**)error {
+    CBLAssertNotNil(documentIDs);
+    
+    UInt64 timestamp = date ? (UInt64)(date.timeIntervalSince1970*msec) : 0;
+    return [self forDocumentIDs: documentIDs error: error
+                         action: ^bool(C4Slice docID, C4Error* outErr) {
+        return c4coll_setDocExpiration(_c4col, docID, timestamp, outErr);
+    }];
+}
+
 - (id<CBLListenerToken>) addChangeListener: (void (^)(CBLCollectionChange*))listener {
     return [self addChangeListenerWithQueue: nil listener: listener];
 }
@@ -477,6 +645,12 @@ NSString* const kCBLDefaultCollectionName = @"_default";
                                                queue: (dispatch_queue_t)queue {
     if (!_colChangeNotifier) {
         _colChangeNotifier = [CBLChangeNotifier new];
+        if (self.db.config.readOnly) {
+            // Observers can't be created on a read-only connection, so changes made through a
+            // writable connection to the same file won't be reported to this listener:
+            CBLWarn(Database, @"%@ Read-only database; the change listener won't be called", self);
+            return [_colChangeNotifier addChangeListenerWithQueue: queue listener: listener delegate: self];
+        }
         C4Error c4err = {};
         _colObs = c4dbobs_createOnCollection(_c4col, colObserverCallback, (__bridge void *)self, &c4err);
         if (!_colObs) {
@@ -595,6 +769,7 @@ static void colObserverCallback(C4CollectionObserver* obs, void* context) {
    concurrencyControl: (CBLConcurrencyControl)concurrencyControl
            asDeletion: (BOOL)deletion
                 error: (NSError**)outError {
+    cbl::TraceSpan span(cbl::TraceEvent::CollectionSaveBegin, cbl::TraceEvent::CollectionSaveEnd);
     
     if (deletion && !document.revisionID)
         return createError(CBLErrorNotFound,
@@ -728,6 +903,12 @@ static void colObserverCallback(C4CollectionObserver* obs, void* context) {
 
 #pragma mark - RESOLVING REPLICATED CONFLICTS:
 
+typedef enum {
+    kConflictReadFailed,        ///< The local doc couldn't be read
+    kConflictReadNoConflict,    ///< There's no conflicting revision (already resolved)
+    kConflictReadOK             ///< Both revisions were read
+} CBLConflictReadResult;
+
 - (bool) resolveConflictInDocument: (NSString*)docID
               withConflictResolver: (id<CBLConflictResolver>)conflictResolver
                              error: (NSError**)outError {
@@ -737,68 +918,19 @@ static void colObserverCallback(C4CollectionObserver* obs, void* context) {
         
         // Get latest local and remote document revisions from DB
         CBL_LOCK(_mutex) {
-            // Read local document:
-            localDoc = [[CBLDocument alloc] initWithCollection: self
-                                                    documentID: docID
-                                                includeDeleted: YES
-                                                  contentLevel: kDocGetCurrentRev
-                                                         error: outError];
-            if (!localDoc) {
-                CBLWarn(Sync, @"Unable to find the document %@ during conflict resolution,\
-                        skipping...", docID);
-                return NO;
-            }
-            
-            // Read the conflicting remote revision:
-            remoteDoc = [[CBLDocument alloc] initWithCollection: self
-                                                     documentID: docID
-                                                 includeDeleted: YES
-                                                   contentLevel: kDocGetAll
-                                                          error: outError];
-            if (!remoteDoc || ![remoteDoc selectConflictingRevision]) {
-                CBLWarn(Sync, @"Unable to select conflicting revision for %@, the conflict may "
-                        "have been resolved...", docID);
-                // this means no conflict, so returning success
-                return YES;
+            switch ([self readConflictInDocument: docID localDoc: &localDoc remoteDoc: &remoteDoc
+                                           error: outError]) {
+                case kConflictReadFailed:       return NO;
+                case kConflictReadNoConflict:   return YES;
+                case kConflictReadOK:           break;
             }
         }
         
-        conflictResolver = conflictResolver ?: [CBLConflictResolver default];
-        
-        // Resolve conflict:
         CBLDocument* resolvedDoc;
-        @try {
-            CBLLogInfo(Sync, @"Resolving doc '%@' (localDoc=%@ and remoteDoc=%@)",
-                       docID, localDoc.revisionID, remoteDoc.revisionID);
-            
-            if (localDoc.isDeleted && remoteDoc.isDeleted) {
-                resolvedDoc = remoteDoc;
-            } else {
-                CBLConflict* conflict = [[CBLConflict alloc] initWithID: docID
-                                                          localDocument: localDoc.isDeleted ? nil : localDoc
-                                                         remoteDocument: remoteDoc.isDeleted ? nil : remoteDoc];
-                
-                resolvedDoc = [conflictResolver resolve: conflict];
-            }
-            
-            if (resolvedDoc && resolvedDoc.id != docID) {
-                CBLWarn(Sync, @"The document ID of the resolved document '%@' is not matching "
-                        "with the document ID of the conflicting document '%@'.",
-                        resolvedDoc.id, docID);
-            }
-            
-            if (resolvedDoc && resolvedDoc.collection && resolvedDoc.collection != self) {
-                [NSException raise: NSInternalInconsistencyException
-                            format: kCBLErrorMessageResolvedDocWrongDb,
-                 resolvedDoc.collection.name, self.name];
-            }
-        } @catch (NSException *ex) {
-            CBLWarn(Sync, @"Exception in conflict resolver: %@", ex.description);
-            *outError = [NSError errorWithDomain: CBLErrorDomain
-                                            code: CBLErrorConflict
-                                        userInfo: @{NSLocalizedDescriptionKey: ex.description}];
+        if (![self resolveConflictInDocument: docID localDoc: localDoc remoteDoc: remoteDoc
+                                    resolver: conflictResolver resolvedDoc: &resolvedDoc
+                                       error: outError])
             return NO;
-        }
         
         NSError* err;
         BOOL success = [self saveResolvedDocument: resolvedDoc withLocalDoc: localDoc
@@ -814,6 +946,189 @@ static void colObserverCallback(C4CollectionObserver* obs, void* context) {
     }
 }
 
+- (NSArray*) resolveConflictsInDocuments: (NSArray<NSString*>*)docIDs
+                    withConflictResolver: (id<CBLConflictResolver>)conflictResolver
+{
+    NSUInteger count = docIDs.count;
+    NSMutableArray* results = [NSMutableArray arrayWithCapacity: count];
+    std::vector<CBLDocument*> localDocs(count), remoteDocs(count), resolvedDocs(count);
+    std::vector<bool> needsSave(count, false);
+    
+    // Read the local and remote revisions of all the documents under a single lock:
+    CBL_LOCK(_mutex) {
+        for (NSUInteger i = 0; i < count; i++) {
+            NSError* error = nil;
+            CBLDocument *localDoc, *remoteDoc;
+            auto result = [self readConflictInDocument: docIDs[i] localDoc: &localDoc
+                                             remoteDoc: &remoteDoc error: &error];
+            if (result == kConflictReadOK) {
+                localDocs[i] = localDoc;
+                remoteDocs[i] = remoteDoc;
+                needsSave[i] = true;
+            }
+            [results addObject: (result == kConflictReadFailed && error) ? error : [NSNull null]];
+        }
+    }
+    
+    // Call the resolver outside the lock:
+    for (NSUInteger i = 0; i < count; i++) {
+        if (!needsSave[i])
+            continue;
+        NSError* error = nil;
+        CBLDocument* resolvedDoc;
+        if ([self resolveConflictInDocument: docIDs[i] localDoc: localDocs[i]
+                                  remoteDoc: remoteDocs[i] resolver: conflictResolver
+                                resolvedDoc: &resolvedDoc error: &error]) {
+            resolvedDocs[i] = resolvedDoc;
+        } else {
+            needsSave[i] = false;
+            results[i] = error;
+        }
+    }
+    
+    // Save all the resolved revisions in one transaction. A doc whose local revision has changed
+    // since it was read goes back through the single-document path, which re-reads it:
+    NSMutableIndexSet* retry = [NSMutableIndexSet indexSet];
+    CBL_LOCK(_mutex) {
+        NSError* error = nil;
+        CBLDatabase* db = _db;
+        if ([self database: db isValid: &error]) {
+            C4Transaction t(db.c4db);
+            if (t.begin()) {
+                NSMutableIndexSet* saved = [NSMutableIndexSet indexSet];
+                for (NSUInteger i = 0; i < count; i++) {
+                    if (!needsSave[i])
+                        continue;
+                    NSError* saveError = nil;
+                    if ([self _saveResolvedDocument: resolvedDocs[i] withLocalDoc: localDocs[i]
+                                          remoteDoc: remoteDocs[i] database: db
+                                              error: &saveError]) {
+                        [saved addIndex: i];
+                    } else if ($equal(saveError.domain, CBLErrorDomain)
+                               && saveError.code == CBLErrorConflict) {
+                        [retry addIndex: i];
+                    } else {
+                        results[i] = saveError;
+                    }
+                }
+                if (!t.commit()) {
+                    convertError(t.error(), &error);
+                    [saved enumerateIndexesUsingBlock: ^(NSUInteger i, BOOL* stop) {
+                        results[i] = error;
+                    }];
+                }
+            } else {
+                convertError(t.error(), &error);
+            }
+        }
+        
+        if (error) {
+            for (NSUInteger i = 0; i < count; i++) {
+                if (needsSave[i] && ![retry containsIndex: i] && results[i] == [NSNull null])
+                    results[i] = error;
+            }
+        }
+    }
+    
+    [retry enumerateIndexesUsingBlock: ^(NSUInteger i, BOOL* stop) {
+        NSError* error = nil;
+        if (![self resolveConflictInDocument: docIDs[i] withConflictResolver: conflictResolver
+                                       error: &error]) {
+            results[i] = error ?: [NSNull null];
+        }
+    }];
+    
+    return results;
+}
+
+/** Reads the current local revision and the conflicting remote revision of a document.
+    Must be called under the lock. */
+- (CBLConflictReadResult) readConflictInDocument: (NSString*)docID
+                                        localDoc: (CBLDocument**)outLocalDoc
+                                       remoteDoc: (CBLDocument**)outRemoteDoc
+                                           error: (NSError**)outError
+{
+    // Read local document:
+    CBLDocument* localDoc = [[CBLDocument alloc] initWithCollection: self
+                                                         documentID: docID
+                                                     includeDeleted: YES
+                                                       contentLevel: kDocGetCurrentRev
+                                                              error: outError];
+    if (!localDoc) {
+        CBLWarn(Sync, @"Unable to find the document %@ during conflict resolution,\
+                skipping...", docID);
+        return kConflictReadFailed;
+    }
+    
+    // Read the conflicting remote revision:
+    CBLDocument* remoteDoc = [[CBLDocument alloc] initWithCollection: self
+                                                          documentID: docID
+                                                      includeDeleted: YES
+                                                        contentLevel: kDocGetAll
+                                                               error: outError];
+    if (!remoteDoc || ![remoteDoc selectConflictingRevision]) {
+        CBLWarn(Sync, @"Unable to select conflicting revision for %@, the conflict may "
+                "have been resolved...", docID);
+        // this means no conflict, so returning success
+        return kConflictReadNoConflict;
+    }
+    
+    *outLocalDoc = localDoc;
+    *outRemoteDoc = remoteDoc;
+    return kConflictReadOK;
+}
+
+/** Calls the conflict resolver. On success, *outResolvedDoc is set to the resolved document,
+    or to nil if the document should be deleted. */
+- (BOOL) resolveConflictInDocument: (NSString*)docID
+                          localDoc: (CBLDocument*)localDoc
+                         remoteDoc: (CBLDocument*)remoteDoc
+                          resolver: (id<CBLConflictResolver>)conflictResolver
+                       resolvedDoc: (CBLDocument**)outResolvedDoc
+                             error: (NSError**)outError
+{
+    conflictResolver = conflictResolver ?: [CBLConflictResolver default];
+    
+    // Resolve conflict:
+    CBLDocument* resolvedDoc;
+    @try {
+        CBLLogInfo(Sync, @"Resolving doc '%@' (localDoc=%@ and remoteDoc=%@)",
+                   docID, localDoc.revisionID, remoteDoc.revisionID);
+        
+        if (localDoc.isDeleted && remoteDoc.isDeleted) {
+            resolvedDoc = remoteDoc;
+        } else {
+            CBLConflict* conflict = [[CBLConflict alloc] initWithID: docID
+                                                      localDocument: localDoc.isDeleted ? nil : localDoc
+                                                     remoteDocument: remoteDoc.isDeleted ? nil : remoteDoc];
+            
+            resolvedDoc = [conflictResolver resolve: conflict];
+        }
+        
+        if (resolvedDoc && resolvedDoc.id != docID) {
+            CBLWarn(Sync, @"The document ID of the resolved document '%@' is not matching "
+                    "with the document ID of the conflicting document '%@'.",
+                    resolvedDoc.id, docID);
+        }
+        
+        if (resolvedDoc && resolvedDoc.collection && resolvedDoc.collection != self) {
+            [NSException raise: NSInternalInconsistencyException
+                        format: kCBLErrorMessageResolvedDocWrongDb,
+             resolvedDoc.collection.name, self.name];
+        }
+    } @catch (NSException *ex) {
+        CBLWarn(Sync, @"Exception in conflict resolver: %@", ex.description);
+        if (outError)
+            *outError = [NSError errorWithDomain: CBLErrorDomain
+                                            code: CBLErrorConflict
+                                        userInfo: @{NSLocalizedDescriptionKey: ex.description}];
+        return NO;
+    }
+    
+    *outResolvedDoc = resolvedDoc;
+    return YES;
+}
+
 - (BOOL) saveResolvedDocument: (CBLDocument*)resolvedDoc
                  withLocalDoc: (CBLDocument*)localDoc
                     remoteDoc: (CBLDocument*)remoteDoc
@@ -828,67 +1143,80 @@ static void colObserverCallback(C4CollectionObserver* obs, void* context) {
         if (!t.begin())
             return convertError(t.error(), outError);
         
-        if (!resolvedDoc) {
-            if (localDoc.isDeleted)
-                resolvedDoc = localDoc;
-            
-            if (remoteDoc.isDeleted)
-                resolvedDoc = remoteDoc;
-        }
-        
-        if (resolvedDoc != localDoc)
-            resolvedDoc.collection = self;
-        
-        // The remote branch has to win, so that the doc revision history matches the server's.
-        CBLStringBytes winningRevID = remoteDoc.revisionID;
-        CBLStringBytes losingRevID = localDoc.revisionID;
-        
-        // mergedRevFlags:
-        C4RevisionFlags mergedFlags = 0;
-        
-        // mergedBody:
-        alloc_slice mergedBody;
-        if (resolvedDoc != remoteDoc) {
-            if (resolvedDoc) {
-                // Unless the remote revision is being used as-is, we need a new revision:
-                NSError* err = nil;
-                mergedBody = [resolvedDoc encodeWithRevFlags: &mergedFlags error: &err];
-                if (err) {
-                    createError(CBLErrorUnexpectedError, err.localizedDescription, outError);
-                    return NO;
-                }
-                
-                if (!mergedBody) {
-                    createError(CBLErrorUnexpectedError, kCBLErrorMessageResolvedDocContainsNull, outError);
-                    return NO;
-                }
-            } else
-                mergedBody = [self emptyFLSliceResult: db];
-        }
-        
-        mergedFlags |= resolvedDoc.c4Doc != nil ? resolvedDoc.c4Doc.revFlags : 0;
-        if (!resolvedDoc || resolvedDoc.isDeleted)
-            mergedFlags |= kRevDeleted;
-        
-        // Tell LiteCore to do the resolution:
-        C4Document *c4doc = localDoc.c4Doc.rawDoc;
-        C4Error c4err;
-        if (!c4doc_resolveConflict(c4doc,
-                                   winningRevID,
-                                   losingRevID,
-                                   mergedBody,
-                                   mergedFlags,
-                                   &c4err)
-            || !c4doc_save(c4doc, 0, &c4err)) {
-            return convertError(c4err, outError);
-        }
-        CBLLogInfo(Sync, @"Conflict resolved as doc '%@' rev %.*s",
-                   localDoc.id, (int)c4doc->revID.size, (char*)c4doc->revID.buf);
+        if (![self _saveResolvedDocument: resolvedDoc withLocalDoc: localDoc remoteDoc: remoteDoc
+                                database: db error: outError])
+            return NO;
         
         return t.commit() || convertError(t.error(), outError);
     }
 }
 
+/** Saves a resolved document. Must be called under the lock, in a transaction. */
+- (BOOL) _saveResolvedDocument: (CBLDocument*)resolvedDoc
+                  withLocalDoc: (CBLDocument*)localDoc
+                     remoteDoc: (CBLDocument*)remoteDoc
+                      database: (CBLDatabase*)db
+                         error: (NSError**)outError
+{
+    if (!resolvedDoc) {
+        if (localDoc.isDeleted)
+            resolvedDoc = localDoc;
+        
+        if (remoteDoc.isDeleted)
+            resolvedDoc = remoteDoc;
+    }
+    
+    if (resolvedDoc != localDoc)
+        resolvedDoc.collection = self;
+    
+    // The remote branch has to win, so that the doc revision history matches the server's.
+    CBLStringBytes winningRevID = remoteDoc.revisionID;
+    CBLStringBytes losingRevID = localDoc.revisionID;
+    
+    // mergedRevFlags:
+    C4RevisionFlags mergedFlags = 0;
+    
+    // mergedBody:
+    alloc_slice mergedBody;
+    if (resolvedDoc != remoteDoc) {
+        if (resolvedDoc) {
+            // Unless the remote revision is being used as-is, we need a new revision:
+            NSError* err = nil;
+            mergedBody = [resolvedDoc encodeWithRevFlags: &mergedFlags error: &err];
+            if (err) {
+                createError(CBLErrorUnexpectedError, err.localizedDescription, outError);
+                return NO;
+            }
+            
+            if (!mergedBody) {
+                createError(CBLErrorUnexpectedError, kCBLErrorMessageResolvedDocContainsNull, outError);
+                return NO;
+            }
+        } else
+            mergedBody = [self emptyFLSliceResult: db];
+    }
+    
+    mergedFlags |= resolvedDoc.c4Doc != nil ? resolvedDoc.c4Doc.revFlags : 0;
+    if (!resolvedDoc || resolvedDoc.isDeleted)
+        mergedFlags |= kRevDeleted;
+    
+    // Tell LiteCore to do the resolution:
+    C4Document *c4doc = localDoc.c4Doc.rawDoc;
+    C4Error c4err;
+    if (!c4doc_resolveConflict(c4doc,
+                               winningRevID,
+                               losingRevID,
+                               mergedBody,
+                               mergedFlags,
+                               &c4err)
+        || !c4doc_save(c4doc, 0, &c4err)) {
+        return convertError(c4err, outError);
+    }
+    CBLLogInfo(Sync, @"Conflict resolved as doc '%@' rev %.*s",
+               localDoc.id, (int)c4doc->revID.size, (char*)c4doc->revID.buf);
+    return YES;
+}
+
 - (FLSliceResult) emptyFLSliceResult: (CBLDatabase*)db {
     FLEncoder enc = c4db_getSharedFleeceEncoder(db.c4db);
     FLEncoder_BeginDict(enc, 0);
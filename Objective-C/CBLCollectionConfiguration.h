@@ -41,6 +41,22 @@ NS_ASSUME_NONNULL_BEGIN
  Only documents of which the function returns true are replicated. */
 @property (nonatomic) CBLReplicationFilter pullFilter;
 
+/**
+ Lightweight filter function for validating whether the documents can be pushed to the remote
+ endpoint. The function is given a read-only view of the revision instead of a CBLDocument,
+ which avoids creating a document for each revision checked. If both pushRevisionFilter and
+ pushFilter are set, a document is only pushed if both functions return true.
+ Only documents of which the function returns true are replicated. */
+@property (nonatomic, nullable) CBLReplicationRevisionFilter pushRevisionFilter;
+
+/**
+ Lightweight filter function for validating whether the documents can be pulled from the remote
+ endpoint. The function is given a read-only view of the revision instead of a CBLDocument,
+ which avoids creating a document for each revision checked. If both pullRevisionFilter and
+ pullFilter are set, a document is only pulled if both functions return true.
+ Only documents of which the function returns true are replicated. */
+@property (nonatomic, nullable) CBLReplicationRevisionFilter pullRevisionFilter;
+
 /**
  Channels filter for specifying the channels for the pull the replicator will pull from.
  For any collections that do not have the channels filter specified, all accessible
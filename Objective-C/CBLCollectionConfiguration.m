@@ -22,6 +22,7 @@
 
 @synthesize documentIDs=_documentIDs, channels=_channels;
 @synthesize pushFilter=_pushFilter, pullFilter=_pullFilter;
+@synthesize pushRevisionFilter=_pushRevisionFilter, pullRevisionFilter=_pullRevisionFilter;
 @synthesize conflictResolver=_conflictResolver;
 
 - (instancetype) initWithConfig: (CBLCollectionConfiguration*)config {
@@ -31,6 +32,8 @@
         _channels = config.channels;
         _pushFilter = config.pushFilter;
         _pullFilter = config.pullFilter;
+        _pushRevisionFilter = config.pushRevisionFilter;
+        _pullRevisionFilter = config.pullRevisionFilter;
         _conflictResolver = config.conflictResolver;
     }
     return self;
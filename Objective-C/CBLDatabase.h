@@ -31,6 +31,7 @@
 @class CBLIndex;
 @class CBLIndexConfiguration;
 @class CBLLog;
+@class CBLMaintenanceTask;
 @class CBLMutableDocument;
 @class CBLQuery;
 @class CBLScope;
@@ -305,6 +306,35 @@ __deprecated_msg("Use [[database defaultCollection] purgeDocumentWithID:error:]
  */
 - (BOOL) performMaintenance: (CBLMaintenanceType)type error: (NSError**)error;
 
+/**
+ Performs database maintenance on a background queue, in short steps that release the database
+ lock in between, so that other threads can keep reading and writing while it runs. Only two
+ types can be split into steps:
+ - Compact, if the database file uses incremental auto-vacuum. Free pages are reclaimed a few at
+   a time, and the steps run for at most the given time slice before releasing the lock. Unused
+   blobs are only deleted by -performMaintenance:error:.
+ - FullOptimize, which analyzes one index per step. Analyzing a large index can take longer
+   than the time slice.
+ Other types, and Compact on a file without incremental auto-vacuum, fail with
+ CBLErrorUnsupported; use -performMaintenance:error: for them. The database can't be closed
+ until the task finishes; closing it cancels the task.
+ 
+ @param type Maintenance type.
+ @param timeSlice The time, in seconds, after which no further step is started before the
+                  database lock is released. Set the value to zero to use the default of
+                  50 milliseconds.
+ @param queue The dispatch queue to call the handlers on. Specify nil to use the main queue.
+ @param progress The handler called after each step with the fraction of the work done.
+ @param completion The handler called once the task finishes, with an error if it failed or was
+                   cancelled.
+ @return The task, which can be used to cancel it.
+ */
+- (CBLMaintenanceTask*) performIncrementalMaintenance: (CBLMaintenanceType)type
+                                            timeSlice: (NSTimeInterval)timeSlice
+                                                queue: (nullable dispatch_queue_t)queue
+                                             progress: (nullable void (^)(double progress))progress
+                                           completion: (void (^)(NSError* _Nullable error))completion;
+
 /**
  Deletes a database of the given name in the given directory.
 
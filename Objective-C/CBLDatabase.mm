@@ -27,11 +27,13 @@
 #import "CBLDocumentFragment.h"
 #import "CBLDocument+Internal.h"
 #import "CBLErrorMessage.h"
+#import "CBLFleece.hh"
 #import "CBLIndexConfiguration+Internal.h"
 #import "CBLIndexSpec.h"
 #import "CBLIndex+Internal.h"
 #import "CBLLog+Admin.h"
 #import "CBLLog+Internal.h"
+#import "CBLMaintenanceTask+Internal.h"
 #import "CBLMisc.h"
 #import "CBLQuery+Internal.h"
 #import "CBLQuery+N1QL.h"
@@ -42,6 +44,7 @@
 #import "Foundation+CBL.h"
 #import "c4BlobStore.h"
 #import "c4Observer.h"
+#import "c4Private.h"
 #import "fleece/Fleece.hh"
 
 #ifdef COUCHBASE_ENTERPRISE
@@ -93,24 +96,43 @@ typedef enum {
     
     // this object will be retained and used to lock from outside classes.
     id _mutex;
+    
+    CBLDatabaseOpenTimings _openTimings;
+    
+    std::unique_ptr<SharedKeyStrings> _sharedKeyStrings;
 }
 
 @synthesize name=_name;
 @synthesize dispatchQueue=_dispatchQueue;
 @synthesize queryQueue=_queryQueue;
 @synthesize c4db=_c4db, sharedKeys=_sharedKeys;
+@synthesize openTimings=_openTimings;
 
 static const C4DatabaseConfig2 kDBConfig = {
     .flags = (kC4DB_Create | kC4DB_AutoCompact),
 };
 
-+ (void) initialize {
-    if (self == [CBLDatabase class]) {
-        NSLog(@"%@", [CBLVersion userAgent]);
-        // Initialize logging
+static const C4DatabaseFlags kReadOnlyDBFlags = (kC4DB_ReadOnly | kC4DB_NonObservable);
+
+static const NSTimeInterval kDefaultMaintenanceTimeSlice = 0.050;
+
+/** Sets up logging the first time LiteCore is about to be used. This used to happen in
+    +initialize, which made any use of the class pay for it (and NSLog the user agent, which the
+    file log header already carries); now it's deferred until a database is opened, copied or
+    deleted, so that the cost shows up in the open timings. */
+static void setupLogging() {
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
         CBLAssertNotNil(CBLLog.sharedInstance);
         CBLLogInfo(Database, @"%@", [CBLVersion userAgent]);
-    }
+    });
+}
+
+static inline double secondsSince(CFAbsoluteTime &start) {
+    CFAbsoluteTime now = CFAbsoluteTimeGetCurrent();
+    double elapsed = now - start;
+    start = now;
+    return elapsed;
 }
 
 - (instancetype) initWithName: (NSString*)name
@@ -125,12 +147,16 @@ static const C4DatabaseConfig2 kDBConfig = {
     
     self = [super init];
     if (self) {
+        CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent(), time = startTime;
+        setupLogging();
         [[self class] checkFileLogging: NO];
+        _openTimings.logSetup = secondsSince(time);
         
         _name = name;
         _config = [[CBLDatabaseConfiguration alloc] initWithConfig: config readonly: YES];
         if (![self open: outError])
             return nil;
+        time = CFAbsoluteTimeGetCurrent();
         
         NSString* qName = $sprintf(@"Database <%@: %@>", self, name);
         _dispatchQueue = dispatch_queue_create(qName.UTF8String, DISPATCH_QUEUE_SERIAL);
@@ -143,6 +169,14 @@ static const C4DatabaseConfig2 kDBConfig = {
         _mutex = [NSObject new];
         
         [self setDefaultCollection];
+        _openTimings.defaultCollection = secondsSince(time);
+        _openTimings.total = time - startTime;
+        
+        CBLLogInfo(Database, @"%@: Opened in %.3f ms (log setup %.3f, directory %.3f, "
+                   "c4db_openNamed %.3f, default collection %.3f)", self,
+                   _openTimings.total * 1000.0, _openTimings.logSetup * 1000.0,
+                   _openTimings.directory * 1000.0, _openTimings.c4Open * 1000.0,
+                   _openTimings.defaultCollection * 1000.0);
     }
     return self;
 }
@@ -157,6 +191,7 @@ static const C4DatabaseConfig2 kDBConfig = {
     if (self) {
         _shellMode = YES;
         _c4db = c4db;
+        _sharedKeyStrings = std::make_unique<SharedKeyStrings>();
         
         _state = kCBLDatabaseStateOpened;
         
@@ -455,11 +490,35 @@ static const C4DatabaseConfig2 kDBConfig = {
     }
 }
 
+- (CBLMaintenanceTask*) performIncrementalMaintenance: (CBLMaintenanceType)type
+                                            timeSlice: (NSTimeInterval)timeSlice
+                                                queue: (nullable dispatch_queue_t)queue
+                                             progress: (nullable void (^)(double progress))progress
+                                           completion: (void (^)(NSError* _Nullable error))completion
+{
+    CBLAssertNotNil(completion);
+    
+    CBLMaintenanceTask* task =
+        [[CBLMaintenanceTask alloc] initWithDatabase: self
+                                                type: type
+                                           timeSlice: (timeSlice > 0 ? timeSlice : kDefaultMaintenanceTimeSlice)
+                                               queue: (queue ?: dispatch_get_main_queue())
+                                            progress: progress
+                                          completion: completion];
+    CBL_LOCK(_mutex) {
+        [self mustBeOpenAndNotClosing];
+        [self addActiveStoppable: task];
+    }
+    [task start];
+    return task;
+}
+
 + (BOOL) deleteDatabase: (NSString*)name
             inDirectory: (nullable NSString*)directory
                   error: (NSError**)outError
 {
     CBLAssertNotNil(name);
+    setupLogging();
     
     C4Error err;
     CBLStringBytes n(name);
@@ -483,6 +542,7 @@ static const C4DatabaseConfig2 kDBConfig = {
 {
     CBLAssertNotNil(path);
     CBLAssertNotNil(name);
+    setupLogging();
     
     NSString* dir = config.directory ?: defaultDirectory();
     if (!setupDatabaseDirectory(dir, outError))
@@ -492,6 +552,7 @@ static const C4DatabaseConfig2 kDBConfig = {
     slice fromPath(path.fileSystemRepresentation);
     CBLStringBytes destinationName(name);
     C4DatabaseConfig2 c4Config = c4DatabaseConfig2(config ?: [CBLDatabaseConfiguration new]);
+    c4Config.flags = kDBConfig.flags; // The copy is always writeable
     CBLStringBytes d(config != nil ? config.directory : CBLDatabaseConfiguration.defaultDirectory);
     c4Config.parentDirectory = d;
     
@@ -962,16 +1023,22 @@ static void throwIfNotOpenError(NSError* error) {
     return _mutex;
 }
 
+- (SharedKeyStrings*) sharedKeyStrings {
+    return _sharedKeyStrings.get();
+}
+
 #pragma mark - PRIVATE
 
 - (BOOL) open: (NSError**)outError {
     if (_c4db)
         return YES;
     
+    CFAbsoluteTime time = CFAbsoluteTimeGetCurrent();
     NSString* dir = _config.directory;
     Assert(dir != nil);
-    if (!setupDatabaseDirectory(dir, outError))
+    if (!_config.readOnly && !setupDatabaseDirectory(dir, outError))
         return NO;
+    _openTimings.directory = secondsSince(time);
 
     if (_name.length == 0)
         return createError(CBLErrorInvalidParameter, outError);
@@ -986,10 +1053,19 @@ static void throwIfNotOpenError(NSError* error) {
     C4Error err;
     CBLStringBytes n(_name);
     _c4db = c4db_openNamed(n, &c4config, &err);
+    _openTimings.c4Open = secondsSince(time);
     if (!_c4db)
         return convertError(err, outError);
     
     _sharedKeys = c4db_getFLSharedKeys(_c4db);
+    if (!_sharedKeyStrings)
+        _sharedKeyStrings = std::make_unique<SharedKeyStrings>();
+    
+    if (!applyTuning(_c4db, _config, outError)) {
+        c4db_release(_c4db);
+        _c4db = nullptr;
+        return NO;
+    }
         
     _state = kCBLDatabaseStateOpened;
     
@@ -1023,6 +1099,8 @@ static BOOL setupDatabaseDirectory(NSString *dir, NSError **outError)
 
 static C4DatabaseConfig2 c4DatabaseConfig2 (CBLDatabaseConfiguration *config) {
     C4DatabaseConfig2 c4config = kDBConfig;
+    if (config.readOnly)
+        c4config.flags = kReadOnlyDBFlags;
 
 #ifdef COUCHBASE_ENTERPRISE
     if (config.encryptionKey)
@@ -1031,6 +1109,34 @@ static C4DatabaseConfig2 c4DatabaseConfig2 (CBLDatabaseConfiguration *config) {
     return c4config;
 }
 
+/** Applies the configuration's SQLite tuning settings, which LiteCore's open flags don't cover,
+    to a newly opened database. Settings left at zero keep LiteCore's defaults. */
+static BOOL applyTuning(C4Database* c4db, CBLDatabaseConfiguration* config, NSError** outError) {
+    NSMutableArray<NSString*>* pragmas = [NSMutableArray array];
+    if (config.pageCacheSize > 0) {
+        // A negative cache_size is in KiB rather than in pages:
+        [pragmas addObject: $sprintf(@"PRAGMA cache_size=-%llu",
+                                     (unsigned long long)MAX(config.pageCacheSize / 1024, 1ull))];
+    }
+    if (config.mmapSize > 0)
+        [pragmas addObject: $sprintf(@"PRAGMA mmap_size=%llu", (unsigned long long)config.mmapSize)];
+    if (config.walAutoCheckpoint > 0)
+        [pragmas addObject: $sprintf(@"PRAGMA wal_autocheckpoint=%u", config.walAutoCheckpoint)];
+    if (config.fullSync)
+        [pragmas addObject: @"PRAGMA synchronous=FULL"];
+    
+    for (NSString* pragma in pragmas) {
+        CBLLogVerbose(Database, @"Tuning database: %@", pragma);
+        C4Error err = {};
+        CBLStringBytes sql(pragma);
+        C4SliceResult result = c4db_rawQuery(c4db, sql, &err);
+        if (!result.buf && err.code != 0)
+            return convertError(err, outError);
+        FLSliceResult_Release(result);
+    }
+    return YES;
+}
+
 #pragma mark delegate(CBLRemovableListenerToken)
 
 - (void) removeToken: (id)token {
@@ -30,6 +30,44 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, copy) NSString* directory;
 
+/**
+ The maximum amount of memory, in bytes, that SQLite may use to cache database pages.
+ A larger cache speeds up reads of a working set that fits in it, at the cost of memory.
+ Set the value to zero (by default) to use the default cache size.
+ */
+@property (nonatomic) uint64_t pageCacheSize;
+
+/**
+ The maximum number of bytes of the database file that SQLite may access through memory-mapped
+ I/O instead of read calls. Mapping more of the file makes reads cheaper but increases the
+ process's virtual memory footprint. Set the value to zero (by default) to use the default size.
+ */
+@property (nonatomic) uint64_t mmapSize;
+
+/**
+ The number of pages the write-ahead log may grow to before SQLite copies it back into the
+ database file. A larger value makes write-heavy workloads faster, at the cost of a larger WAL
+ file and slower reads while it is big. Set the value to zero (by default) to use the default
+ interval.
+ */
+@property (nonatomic) uint32_t walAutoCheckpoint;
+
+/**
+ When YES, every transaction commit waits until its data has been flushed to disk, so committed
+ changes survive a power failure or OS crash. When NO (by default), commits are durable across
+ app crashes but the most recent ones may be lost if the OS crashes; this is much faster.
+ */
+@property (nonatomic) BOOL fullSync;
+
+/**
+ When YES, the database is opened read-only, for processes that only need to read it, such as app
+ extensions. The database must already exist. Any number of read-only instances, in any number of
+ processes, can read while another instance writes, and they see its changes once committed.
+ Attempts to modify the database fail with a CBLErrorNotWriteable error, and change listeners
+ are never called. The default value is NO.
+ */
+@property (nonatomic) BOOL readOnly;
+
 /**
  Initializes the CBLDatabaseConfiguration object.
  */
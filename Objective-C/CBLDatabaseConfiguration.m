@@ -25,6 +25,9 @@
 }
 
 @synthesize directory=_directory;
+@synthesize pageCacheSize=_pageCacheSize, mmapSize=_mmapSize;
+@synthesize walAutoCheckpoint=_walAutoCheckpoint, fullSync=_fullSync;
+@synthesize readOnly=_readOnlyDatabase;
 
 #ifdef COUCHBASE_ENTERPRISE
 @synthesize encryptionKey=_encryptionKey;
@@ -47,6 +50,11 @@
         
         if (config) {
             _directory = config.directory;
+            _pageCacheSize = config.pageCacheSize;
+            _mmapSize = config.mmapSize;
+            _walAutoCheckpoint = config.walAutoCheckpoint;
+            _fullSync = config.fullSync;
+            _readOnlyDatabase = config.readOnly;
 #ifdef COUCHBASE_ENTERPRISE
             _encryptionKey = config.encryptionKey;
 #endif
@@ -64,6 +72,31 @@
     _directory = directory;
 }
 
+- (void) setPageCacheSize: (uint64_t)pageCacheSize {
+    [self checkReadonly];
+    _pageCacheSize = pageCacheSize;
+}
+
+- (void) setMmapSize: (uint64_t)mmapSize {
+    [self checkReadonly];
+    _mmapSize = mmapSize;
+}
+
+- (void) setWalAutoCheckpoint: (uint32_t)walAutoCheckpoint {
+    [self checkReadonly];
+    _walAutoCheckpoint = walAutoCheckpoint;
+}
+
+- (void) setFullSync: (BOOL)fullSync {
+    [self checkReadonly];
+    _fullSync = fullSync;
+}
+
+- (void) setReadOnly: (BOOL)readOnly {
+    [self checkReadonly];
+    _readOnlyDatabase = readOnly;
+}
+
 #pragma mark - Internal
 
 - (void) checkReadonly {
@@ -22,6 +22,7 @@
 @class CBLBlob;
 @class CBLArray;
 @class CBLDictionary;
+@class CBLKeyPath;
 @class CBLMutableDictionary;
 
 
@@ -173,6 +174,30 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (BOOL) containsValueForKey: (NSString*)key;
 
+#pragma mark - Key Paths
+
+/**
+ Gets the value at a key path, such as "address.street" or "phones[0].number". Only the value
+ at the end of the path is converted to an object; the dictionaries and arrays along the way
+ are not, which makes this cheaper than chaining the type getters.
+ 
+ The path is compiled the first time it's used and cached; see CBLKeyPath for its syntax.
+ An invalid path raises an NSInvalidArgumentException.
+ 
+ @param path The key path.
+ @return The value at the key path, or nil if the path doesn't exist.
+ */
+- (nullable id) valueAtKeyPath: (NSString*)path;
+
+/**
+ Gets the value at a precompiled key path. Only the value at the end of the path is converted
+ to an object.
+ 
+ @param keyPath The key path.
+ @return The value at the key path, or nil if the path doesn't exist.
+ */
+- (nullable id) valueAtCompiledKeyPath: (CBLKeyPath*)keyPath;
+
 #pragma mark - Data
 
 /**
@@ -25,10 +25,12 @@
 #import "CBLDocument+Internal.h"
 #import "CBLFleece.hh"
 #import "CBLJSON.h"
+#import "CBLKeyPath+Internal.h"
 #import "CBLStringBytes.h"
 #import "CBLStatus.h"
 #import "MDict.hh"
 #import "MDictIterator.hh"
+#import "MRoot.hh"
 
 using namespace cbl;
 using namespace fleece;
@@ -133,11 +135,10 @@ static const MValue<id>& _get(MDict<id> &dict, NSString* key) {
 }
 
 static id _getObject(MDict<id> &dict, NSString* key, Class asClass =nil) {
-    //OPT: Can return nil before calling asNative, if MValue.value exists and is wrong type
-    id obj = _get(dict, key).asNative(&dict);
-    if (asClass && ![obj isKindOfClass: asClass])
-        obj = nil;
-    return obj;
+    auto &val = _get(dict, key);
+    if (asClass)
+        return asObjectOfClass(val, dict, asClass);
+    return val.asNative(&dict);
 }
 
 - (nullable id) valueForKey: (NSString*)key {
@@ -152,7 +153,7 @@ static id _getObject(MDict<id> &dict, NSString* key, Class asClass =nil) {
     CBLAssertNotNil(key);
     
     CBL_LOCK(_sharedLock) {
-        return _getObject(_dict, key, [NSString class]);
+        return asString(_get(_dict, key), _dict);
     }
 }
 
@@ -160,7 +161,7 @@ static id _getObject(MDict<id> &dict, NSString* key, Class asClass =nil) {
     CBLAssertNotNil(key);
     
     CBL_LOCK(_sharedLock) {
-        return _getObject(_dict, key, [NSNumber class]);
+        return asNumber(_get(_dict, key), _dict);
     }
 }
 
@@ -208,7 +209,7 @@ static id _getObject(MDict<id> &dict, NSString* key, Class asClass =nil) {
     CBLAssertNotNil(key);
     
     CBL_LOCK(_sharedLock) {
-        return asDate(_getObject(_dict, key, nil));
+        return asDate(_get(_dict, key), _dict);
     }
 }
 
@@ -246,6 +247,39 @@ static id _getObject(MDict<id> &dict, NSString* key, Class asClass =nil) {
     }
 }
 
+#pragma mark - Key Paths
+
+- (nullable id) valueAtKeyPath: (NSString*)path {
+    return [self valueAtCompiledKeyPath: CBLKeyPathForString(path)];
+}
+
+- (nullable id) valueAtCompiledKeyPath: (CBLKeyPath*)keyPath {
+    CBLAssertNotNil(keyPath);
+    
+    NSString* key = keyPath.firstKey;
+    if (!key)
+        return nil;
+    
+    CBL_LOCK(_sharedLock) {
+        // A child's Fleece value is cleared when anything under it is modified, so if it's still
+        // there the rest of the path can be evaluated on the Fleece data:
+        Value value = _get(_dict, key).value();
+        if (!value)
+            return [keyPath evaluateObject: self];
+        
+        CBLDatabase* db = static_cast<DocContext*>(_dict.context())->database();
+        Value leaf = [keyPath evaluateFleeceAfterFirst: value sharedKeys: db.sharedKeys];
+        if (!leaf)
+            return nil;
+        if (_dict.isMutable() && (leaf.type() == kFLDict || leaf.type() == kFLArray)) {
+            // A mutable collection has to be attached to its parent, so take the slow path:
+            return [keyPath evaluateObject: self];
+        }
+        MRoot<id> root(_dict.context(), leaf, false);
+        return root.asNative();
+    }
+}
+
 #pragma mark - Data
 
 - (NSDictionary<NSString*,id>*) toDictionary {
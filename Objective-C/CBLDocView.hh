@@ -0,0 +1,175 @@
+//
+//  CBLDocView.hh
+//  CouchbaseLite
+//
+//  Copyright (c) 2022 Couchbase, Inc All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#pragma once
+#import "CBLDocument+Fleece.h"
+#import "fleece/Fleece.hh"
+#import <array>
+#import <string>
+#import <type_traits>
+#import <utility>
+
+NS_ASSUME_NONNULL_BEGIN
+
+namespace cbl {
+
+    /** A typed property of a document schema. `T` is the C++ type to read it as, and `I` the
+        index of its key in the schema's `kKeys` array. */
+    template <class T, size_t I>
+    struct Field {
+        using type = T;
+        static constexpr size_t index = I;
+    };
+
+    /** Reads typed properties straight out of a document's Fleece body, without creating any
+        Objective-C objects or converting key strings. This header is for C++ code that embeds
+        Couchbase Lite along with the Fleece headers; it isn't imported by CouchbaseLite.h. The schema is a struct declaring its keys
+        and fields at compile time:
+
+            struct Person {
+                static constexpr std::array<fleece::slice, 2> kKeys {"name"_sl, "age"_sl};
+                static constexpr cbl::Field<fleece::slice, 0> name {};
+                static constexpr cbl::Field<int64_t, 1>       age {};
+            };
+
+            cbl::DocView<Person> person(doc);
+            int64_t age = person[Person::age];
+
+        Each thread keeps its own Fleece `FLDictKey` per schema key, which caches the key's
+        shared-key number after the first lookup, so later lookups are an integer compare.
+        Shared-key numbers are specific to a database, so the cached keys belong to the shared
+        keys of the last body read on the thread, and are rebuilt when a view reads a body from
+        a different database.
+
+        Supported field types are bool, the integer and floating-point types, fleece::slice
+        (pointing into the document body, valid while the view exists), std::string, and
+        fleece::Value/Array/Dict. Missing or mistyped properties read as 0, false or null.
+
+        The view reads the document's saved revision: unsaved changes to a CBLMutableDocument
+        are not visible. Keep the view on the stack; it's as thread-safe as the document. */
+    template <class Schema>
+    class DocView {
+    public:
+        static constexpr size_t kKeyCount = std::tuple_size<decltype(Schema::kKeys)>::value;
+
+        explicit DocView(CBLDocument* doc)
+        :_doc(doc)
+        ,_body(doc.fleeceData)
+        ,_sharedKeys(doc.fleeceSharedKeys)
+        {
+            if (!_sharedKeys)
+                _sharedKeys = sharedKeysOf(_body);
+        }
+
+        explicit DocView(FLDict body)
+        :_body(body)
+        ,_sharedKeys(sharedKeysOf(body))
+        { }
+
+        /** True if the document has a body, i.e. it exists and isn't deleted. */
+        explicit operator bool() const              {return _body != nullptr;}
+
+        template <class T, size_t I>
+        T get(Field<T,I>) const {
+            return valueAs<T>(value<I>());
+        }
+
+        template <class T, size_t I>
+        T operator[] (Field<T,I> field) const       {return get(field);}
+
+        template <class T, size_t I>
+        bool contains(Field<T,I>) const {
+            return value<I>() != nullptr;
+        }
+
+    private:
+        template <size_t I>
+        fleece::Value value() const {
+            static_assert(I < kKeyCount, "Field index is out of range of the schema's keys");
+            return FLDict_GetWithKey(_body, &keys(_sharedKeys)[I]);
+        }
+
+        using KeyArray = std::array<FLDictKey, kKeyCount>;
+
+        // The thread's keys, with their cached numbers, for bodies that use `sharedKeys`.
+        // The shared keys are retained so that their address can't be reused by another
+        // database's shared keys while they're cached.
+        static KeyArray& keys(FLSharedKeys sharedKeys) {
+            struct Cache {
+                FLSharedKeys sharedKeys {nullptr};
+                KeyArray keys = makeKeys(std::make_index_sequence<kKeyCount>{});
+                ~Cache()                        {FLSharedKeys_Release(sharedKeys);}
+            };
+            static thread_local Cache sCache;
+            if (sharedKeys != sCache.sharedKeys) {
+                FLSharedKeys_Release(sCache.sharedKeys);
+                sCache.sharedKeys = FLSharedKeys_Retain(sharedKeys);
+                sCache.keys = makeKeys(std::make_index_sequence<kKeyCount>{});
+            }
+            return sCache.keys;
+        }
+
+        template <size_t... Is>
+        static KeyArray makeKeys(std::index_sequence<Is...>) {
+            return {FLDictKey_Init(Schema::kKeys[Is])...};
+        }
+
+        static FLSharedKeys __nullable sharedKeysOf(FLDict __nullable body) {
+            if (!body)
+                return nullptr;
+            FLDoc doc = FLValue_FindDoc((FLValue)body);
+            FLSharedKeys sharedKeys = FLDoc_GetSharedKeys(doc);
+            FLDoc_Release(doc);
+            return sharedKeys;
+        }
+
+        template <class T>
+        static T valueAs(fleece::Value v) {
+            if constexpr (std::is_same_v<T, bool>)
+                return v.asBool();
+            else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+                return (T)v.asInt();
+            else if constexpr (std::is_integral_v<T>)
+                return (T)v.asUnsigned();
+            else if constexpr (std::is_same_v<T, float>)
+                return v.asFloat();
+            else if constexpr (std::is_same_v<T, double>)
+                return v.asDouble();
+            else if constexpr (std::is_same_v<T, fleece::slice>)
+                return v.asString();
+            else if constexpr (std::is_same_v<T, std::string>)
+                return std::string(v.asString());
+            else if constexpr (std::is_same_v<T, fleece::Array>)
+                return v.asArray();
+            else if constexpr (std::is_same_v<T, fleece::Dict>)
+                return v.asDict();
+            else if constexpr (std::is_same_v<T, fleece::Value>)
+                return v;
+            else
+                static_assert(!sizeof(T), "Unsupported DocView field type");
+        }
+
+        CBLDocument* __nullable _doc {nil};     // Keeps the body alive
+        fleece::Dict _body;
+        FLSharedKeys __nullable _sharedKeys;    // The shared keys _body was encoded with
+    };
+
+}
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,41 @@
+//
+//  CBLDocument+Fleece.h
+//  CouchbaseLite
+//
+//  Copyright (c) 2022 Couchbase, Inc All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import <Foundation/Foundation.h>
+#import "CBLDocument.h"
+#import "fleece/Fleece.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/** Low-level access to a document's Fleece-encoded body, for C and C++ code that embeds
+    Couchbase Lite along with the Fleece headers. Not imported by CouchbaseLite.h. */
+@interface CBLDocument (Fleece)
+
+/** The body of the document's saved revision, or NULL if the document doesn't exist or is
+    deleted. It stays valid as long as the document does; don't modify or release it. Unsaved
+    changes to a CBLMutableDocument are not included. */
+@property (nonatomic, readonly, nullable) FLDict fleeceData;
+
+/** The shared keys the body was encoded with, which are specific to the database. NULL if the
+    document doesn't belong to an open database. */
+@property (nonatomic, readonly, nullable) FLSharedKeys fleeceSharedKeys;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -28,17 +28,21 @@
 #import "CBLStringBytes.h"
 #import "CBLFleece.hh"
 #import "MRoot.hh"
+#import <optional>
 #import "CBLErrorMessage.h"
 
 using namespace fleece;
 
 @implementation CBLDocument
 {
-    std::unique_ptr<MRoot<id>> _root;
+    std::optional<MRoot<id>> _root;     // Stored inline, to save a heap allocation per document
+    FLDict _fleeceData;                 // Body of the current revision, if loaded
+    FLDict _rootData;                   // The revision body _root was loaded from, if any
+    BOOL _bodyPending;                  // YES if only the metadata of _c4Doc has been loaded
     NSError* _encodingError;
 }
 
-@synthesize id=_id, c4Doc=_c4Doc, fleeceData=_fleeceData;
+@synthesize id=_id, c4Doc=_c4Doc;
 @synthesize collection=_collection;
 
 - (instancetype) initWithCollection: (nullable CBLCollection*)collection
@@ -108,7 +112,13 @@ using namespace fleece;
             return nil;
         }
         
-        [self setC4Doc: [CBLC4Document document: doc]];
+        if (contentLevel == kDocGetMetadata && (doc->flags & kDocExists) != 0) {
+            // Defer reading the body until a property is accessed:
+            [self replaceC4Doc: [CBLC4Document document: doc]];
+            _bodyPending = YES;
+        } else {
+            [self setC4Doc: [CBLC4Document document: doc]];
+        }
     }
     return self;
 }
@@ -131,6 +141,8 @@ using namespace fleece;
 }
 
 - (CBLMutableDocument*) mutableCopyWithZone: (NSZone*)zone {
+    // The copy is initialized from the c4doc's body, so make sure it's been loaded:
+    [self loadedDict];
     return [[CBLMutableDocument alloc] initAsCopyWithDocument: self dict: nil];
 }
 
@@ -142,7 +154,7 @@ using namespace fleece;
 }
 
 - (NSString*) toJSON {
-    return [_dict toJSON];
+    return [self.loadedDict toJSON];
 }
 
 #pragma mark - Internal
@@ -161,8 +173,45 @@ using namespace fleece;
     return false;
 }
 
+- (BOOL) changed {
+    // CBLMutableDocument overrides this
+    return NO;
+}
+
 - (BOOL) isEmpty {
-    return _dict.count == 0;
+    return self.loadedDict.count == 0;
+}
+
+- (CBLDictionary*) loadedDict {
+    if (_usuallyFalse(_bodyPending))
+        [self loadBody];
+    return _dict;
+}
+
+// Loads the body of a document that was fetched with only its metadata. If the revision body
+// can't be read any more (e.g. it has been compacted away), the document will appear empty.
+- (void) loadBody {
+    CBLDatabase* db = _collection.db;
+    CBL_LOCK(self) {
+        if (!_bodyPending)
+            return;
+        _bodyPending = NO;
+        
+        if (!db) {
+            CBLWarn(Database, @"Unable to load the document's content as the db has been released.");
+            return;
+        }
+        
+        __block bool loaded = false;
+        __block C4Error err = {};
+        [db safeBlock: ^{
+            loaded = c4doc_loadRevisionBody(_c4Doc.rawDoc, &err);
+        }];
+        if (!loaded)
+            CBLWarnError(Database, @"%@: Failed to load the revision body: %d/%d",
+                         self, err.domain, err.code);
+        self.c4Doc = _c4Doc;
+    }
 }
 
 - (void) updateDictionary {
@@ -172,18 +221,31 @@ using namespace fleece;
             CBLWarn(Database, @"Unable to update the document's content as the db has been released.");
             return;
         }
-        _root.reset(new MRoot<id>(new cbl::DocContext(db, _c4Doc), Dict(_fleeceData), self.isMutable));
+        _root.emplace(new cbl::DocContext(db, _c4Doc), Dict(_fleeceData), self.isMutable);
+        _rootData = _fleeceData;
         [db safeBlock:^{
             _dict = _root->asNative();
         }];
     } else {
         // New document:
         _root.reset();
+        _rootData = nullptr;
         _dict = self.isMutable ? (id)[[CBLNewDictionary alloc] init]
                                : [[CBLDictionary alloc] initEmpty];
     }
 }
 
+- (FLDict) fleeceData {
+    if (_usuallyFalse(_bodyPending))
+        [self loadBody];
+    return _fleeceData;
+}
+
+- (FLSharedKeys) fleeceSharedKeys {
+    CBLDatabase* db = _collection.db;
+    return db.c4db ? db.sharedKeys : nullptr;
+}
+
 - (CBLC4Document*) c4Doc {
     CBL_LOCK(self) {
         return _c4Doc;
@@ -193,6 +255,7 @@ using namespace fleece;
 - (void) setC4Doc: (CBLC4Document*)c4doc {
     CBL_LOCK(self) {
         _c4Doc = c4doc;
+        _bodyPending = NO;
         _fleeceData = nullptr;
         
         if (c4doc)
@@ -204,10 +267,33 @@ using namespace fleece;
 
 - (void) replaceC4Doc: (CBLC4Document*)c4doc {
     CBL_LOCK(self) {
+        if (_bodyPending)
+            [self loadBody];    // Needs the old c4doc to read the body from
         _c4Doc = c4doc;
     }
 }
 
+- (BOOL) setContentWithJSON: (NSString*)json error: (NSError**)outError {
+    CBLStringBytes jsonSlice(json);
+    alloc_slice data = cbl::convertJSON(jsonSlice, outError);
+    if (!data)
+        return NO;
+    
+    Dict root = Value(FLValue_FromData(data, kFLTrusted)).asDict();
+    if (!root) {
+        CBLWarnError(Database, @"%@: Failed to convert FLValue to NSDictionary", self);
+        return createError(CBLErrorInvalidJSON, @"Parsed result is not a Dictionary", outError);
+    }
+    
+    CBL_LOCK(self) {
+        auto context = new cbl::DocContext(_collection.db, _c4Doc, data);
+        _root.emplace(context, root, self.isMutable);
+        _rootData = nullptr;
+        _dict = _root->asNative();
+    }
+    return YES;
+}
+
 #pragma mark - Fleece Encoding
 
 - (FLSliceResult) encodeWithRevFlags: (C4RevisionFlags*)outRevFlags error:(NSError**)outError {
@@ -219,11 +305,21 @@ using namespace fleece;
         return {};
     }
     
+    // If the properties haven't been changed since they were loaded from the current revision,
+    // save its body as-is instead of encoding them again:
+    CBLDictionary* dict = self.loadedDict;
+    CBLC4Document* c4doc = self.c4Doc;
+    if (_rootData && c4doc && !self.changed && c4doc_getProperties(c4doc.rawDoc) == _rootData) {
+        if (outRevFlags)
+            *outRevFlags |= (c4doc.revFlags & kRevHasAttachments);
+        return FLSlice_Copy(c4doc_getRevisionBody(c4doc.rawDoc));
+    }
+    
     auto encoder = c4db_getSharedFleeceEncoder(c4db);
     bool hasAttachment = false;
     FLEncoderContext ctx = { .document = self, .outHasAttachment = &hasAttachment };
     FLEncoder_SetExtraInfo(encoder, &ctx);
-    [_dict fl_encodeToFLEncoder: encoder];
+    [dict fl_encodeToFLEncoder: encoder];
     if (_encodingError != nil) {
         FLEncoder_Reset(encoder);
         if (outError)
@@ -316,78 +412,86 @@ using namespace fleece;
 #pragma mark - CBLDictionary
 
 - (NSUInteger) count {
-    return _dict.count;
+    return self.loadedDict.count;
 }
 
 - (NSArray*) keys {
-    return _dict.keys;
+    return self.loadedDict.keys;
 }
 
 - (nullable id) valueForKey: (nonnull NSString*)key {
-    return [_dict valueForKey: key];
+    return [self.loadedDict valueForKey: key];
 }
 
 - (nullable NSString*) stringForKey: (nonnull NSString*)key {
-    return [_dict stringForKey: key];
+    return [self.loadedDict stringForKey: key];
 }
 
 - (nullable NSNumber*) numberForKey: (nonnull NSString*)key {
-    return [_dict numberForKey: key];
+    return [self.loadedDict numberForKey: key];
 }
 
 - (NSInteger) integerForKey:(nonnull NSString*)key {
-    return [_dict integerForKey: key];
+    return [self.loadedDict integerForKey: key];
 }
 
 - (long long) longLongForKey: (nonnull NSString*)key {
-    return [_dict longLongForKey: key];
+    return [self.loadedDict longLongForKey: key];
 }
 
 - (float) floatForKey: (nonnull NSString*)key {
-    return [_dict floatForKey: key];
+    return [self.loadedDict floatForKey: key];
 }
 
 - (double) doubleForKey: (nonnull NSString*)key {
-    return [_dict doubleForKey: key];
+    return [self.loadedDict doubleForKey: key];
 }
 
 - (BOOL) booleanForKey: (nonnull NSString*)key {
-    return [_dict booleanForKey: key];
+    return [self.loadedDict booleanForKey: key];
 }
 
 - (nullable NSDate*) dateForKey: (nonnull NSString*)key {
-    return [_dict dateForKey: key];
+    return [self.loadedDict dateForKey: key];
 }
 
 - (nullable CBLBlob*) blobForKey: (nonnull NSString*)key {
-    return [_dict blobForKey: key];
+    return [self.loadedDict blobForKey: key];
 }
 
 - (nullable CBLArray*) arrayForKey: (nonnull NSString*)key {
-    return [_dict arrayForKey: key];
+    return [self.loadedDict arrayForKey: key];
 }
 
 - (nullable CBLDictionary*) dictionaryForKey:(nonnull NSString*)key {
-    return [_dict dictionaryForKey: key];
+    return [self.loadedDict dictionaryForKey: key];
 }
 
 - (BOOL) containsValueForKey: (nonnull NSString *)key {
-    return [_dict booleanForKey: key];
+    return [self.loadedDict booleanForKey: key];
+}
+
+- (nullable id) valueAtKeyPath: (NSString*)path {
+    return [self.loadedDict valueAtKeyPath: path];
+}
+
+- (nullable id) valueAtCompiledKeyPath: (CBLKeyPath*)keyPath {
+    return [self.loadedDict valueAtCompiledKeyPath: keyPath];
 }
 
 - (CBLFragment *) objectForKeyedSubscript: (NSString *)key {
-    return [_dict objectForKeyedSubscript: key];
+    return [self.loadedDict objectForKeyedSubscript: key];
 }
 
 - (NSUInteger) countByEnumeratingWithState: (nonnull NSFastEnumerationState*)state
                                    objects: (id  _Nullable __unsafe_unretained* _Nonnull)buffer
                                      count: (NSUInteger)len
 {
-    return [_dict countByEnumeratingWithState: state objects: buffer count: len];
+    return [self.loadedDict countByEnumeratingWithState: state objects: buffer count: len];
 }
 
 - (NSDictionary<NSString *,id>*) toDictionary {
-    return [_dict toDictionary];
+    return [self.loadedDict toDictionary];
 }
 
 #pragma mark - Equality
@@ -406,11 +510,11 @@ using namespace fleece;
     if (![self.id isEqualToString: other.id])
         return NO;
     
-    return [_dict isEqual: other->_dict];
+    return [self.loadedDict isEqual: other.loadedDict];
 }
 
 - (NSUInteger) hash {
-    return [self.collection hash] ^ [self.id hash] ^ [_dict hash];
+    return [self.collection hash] ^ [self.id hash] ^ [self.loadedDict hash];
 }
 
 @end
@@ -42,6 +42,29 @@ NS_ASSUME_NONNULL_BEGIN
 
 @end
 
+/**
+ Summary of a batch of replicated documents, for listeners that only need the number of
+ documents replicated and the documents that failed. Unlike CBLDocumentReplication, it doesn't
+ require an object to be created for each successfully replicated document. */
+@interface CBLDocumentReplicationSummary : NSObject
+
+/** The replicator. */
+@property (nonatomic, readonly) CBLReplicator* replicator;
+
+/** The flag indicating that the replication is push or pull. */
+@property (nonatomic, readonly) BOOL isPush;
+
+/** The number of documents in the batch, including the failed ones. */
+@property (nonatomic, readonly) NSUInteger documentCount;
+
+/** The documents in the batch that failed to replicate. */
+@property (nonatomic, readonly) NSArray<CBLReplicatedDocument*>* failedDocuments;
+
+/** Not available */
+- (instancetype) init NS_UNAVAILABLE;
+
+@end
+
 /// CBLReplicatedDocument contains the information of a document that has been replicated.
 @interface CBLReplicatedDocument : NSObject
 
@@ -42,6 +42,28 @@
 
 @end
 
+@implementation CBLDocumentReplicationSummary
+
+@synthesize replicator=_replicator, isPush=_isPush;
+@synthesize documentCount=_documentCount, failedDocuments=_failedDocuments;
+
+- (instancetype) initWithReplicator: (CBLReplicator*)replicator
+                             isPush: (BOOL)isPush
+                      documentCount: (NSUInteger)documentCount
+                    failedDocuments: (NSArray<CBLReplicatedDocument*>*)failedDocuments
+{
+    self = [super init];
+    if (self) {
+        _replicator = replicator;
+        _isPush = isPush;
+        _documentCount = documentCount;
+        _failedDocuments = failedDocuments;
+    }
+    return self;
+}
+
+@end
+
 @implementation CBLReplicatedDocument
 
 @synthesize id=_id, flags=_flags, c4Error=_c4Error;
@@ -41,6 +41,7 @@
     if (_level != level) {
         _level = level;
         c4log_setBinaryFileLevel((C4LogLevel)level);
+        [[CBLLog sharedInstance] updateEffectiveLogLevels];
     }
 }
 
@@ -52,6 +53,7 @@
         }
         _config = config;
         [self apply];
+        [[CBLLog sharedInstance] updateEffectiveLogLevels];
     }
 }
 
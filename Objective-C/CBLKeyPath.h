@@ -0,0 +1,59 @@
+//
+//  CBLKeyPath.h
+//  CouchbaseLite
+//
+//  Copyright (c) 2022 Couchbase, Inc All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A parsed property path, such as "address.city" or "contacts[0].phones[-1]", that can be
+ evaluated against any number of dictionaries, documents and query results without being parsed
+ again. Keys are separated by periods and array indexes are written in brackets; negative
+ indexes count back from the end of the array. A backslash escapes a period, bracket or
+ backslash that is part of a key.
+ */
+@interface CBLKeyPath : NSObject
+
+/** The path string. */
+@property (readonly, nonatomic) NSString* path;
+
+/**
+ Parses a property path.
+ 
+ @param path The path string.
+ @param error On return, the error if the path is invalid.
+ @return The key path, or nil if the path is invalid.
+ */
++ (nullable instancetype) keyPathWithString: (NSString*)path error: (NSError**)error;
+
+/**
+ Parses a property path.
+ 
+ @param path The path string.
+ @param error On return, the error if the path is invalid.
+ @return The key path, or nil if the path is invalid.
+ */
+- (nullable instancetype) initWithString: (NSString*)path error: (NSError**)error;
+
+/** Not available */
+- (instancetype) init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,254 @@
+//
+//  CBLKeyPath.mm
+//  CouchbaseLite
+//
+//  Copyright (c) 2022 Couchbase, Inc All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import "CBLKeyPath+Internal.h"
+#import "CBLArray.h"
+#import "CBLDictionary.h"
+#import "CBLStatus.h"
+#import "CBLStringBytes.h"
+#import "fleece/Fleece.hh"
+#import <algorithm>
+#import <mutex>
+#import <vector>
+
+using namespace fleece;
+
+// Fleece's KeyPath remembers the shared-key number of each key after its first lookup, and
+// shared keys are specific to a database, so a path is compiled separately for each set of
+// shared keys it's evaluated with. A few are kept, most recently used last.
+static constexpr size_t kMaxCompiledPaths = 4;
+
+namespace {
+    struct CompiledPath {
+        FLSharedKeys sharedKeys;            // Retained, so its address can't be reused
+        KeyPath* path;
+    };
+}
+
+@implementation CBLKeyPath
+{
+    NSArray* _components;                   // NSString keys and NSNumber indexes
+    NSString* _tail;                        // Path without the first component, or nil
+    std::vector<CompiledPath> _compiledTails;
+    std::mutex _mutex;                      // KeyPath caches shared keys, so isn't thread-safe
+}
+
+@synthesize path=_path;
+
++ (instancetype) keyPathWithString: (NSString*)path error: (NSError**)error {
+    return [[self alloc] initWithString: path error: error];
+}
+
+- (instancetype) initWithString: (NSString*)path error: (NSError**)outError {
+    CBLAssertNotNil(path);
+    
+    self = [super init];
+    if (self) {
+        _path = [path copy];
+        NSString* tail;
+        _components = parseKeyPath(_path, &tail, outError);
+        if (!_components)
+            return nil;
+        _tail = tail;
+        
+        // Make sure Fleece can compile the path too:
+        FLError flErr = kFLNoError;
+        CBLStringBytes pathBytes(_path);
+        KeyPath checkPath(pathBytes, &flErr);
+        if (flErr == kFLNoError && _tail) {
+            CBLStringBytes tailBytes(_tail);
+            KeyPath checkTail(tailBytes, &flErr);
+        }
+        if (flErr != kFLNoError) {
+            convertError(flErr, outError);
+            return nil;
+        }
+    }
+    return self;
+}
+
+- (void) dealloc {
+    for (auto &compiled : _compiledTails) {
+        delete compiled.path;
+        FLSharedKeys_Release(compiled.sharedKeys);
+    }
+}
+
+- (NSString*) description {
+    return [NSString stringWithFormat: @"%@[%@]", self.class, _path];
+}
+
+- (nullable NSString*) firstKey {
+    id first = _components.firstObject;
+    return [first isKindOfClass: [NSString class]] ? first : nil;
+}
+
+- (NSInteger) firstIndex {
+    id first = _components.firstObject;
+    return [first isKindOfClass: [NSNumber class]] ? [first integerValue] : NSNotFound;
+}
+
+- (FLValue) evaluateFleeceAfterFirst: (FLValue)root sharedKeys: (FLSharedKeys)sharedKeys {
+    if (!root || !_tail)
+        return root;
+    std::lock_guard<std::mutex> lock(_mutex);
+    return [self compiledTailForSharedKeys: sharedKeys]->eval(root);
+}
+
+// Must be called with _mutex locked.
+- (KeyPath*) compiledTailForSharedKeys: (FLSharedKeys)sharedKeys {
+    auto i = std::find_if(_compiledTails.begin(), _compiledTails.end(),
+                          [&](const CompiledPath &c) {return c.sharedKeys == sharedKeys;});
+    if (i != _compiledTails.end()) {
+        std::rotate(i, i + 1, _compiledTails.end());
+        return _compiledTails.back().path;
+    }
+    
+    if (_compiledTails.size() >= kMaxCompiledPaths) {
+        delete _compiledTails.front().path;
+        FLSharedKeys_Release(_compiledTails.front().sharedKeys);
+        _compiledTails.erase(_compiledTails.begin());
+    }
+    CBLStringBytes tailBytes(_tail);
+    FLError flErr = kFLNoError;
+    auto path = new KeyPath(tailBytes, &flErr);     // Already checked in the initializer
+    _compiledTails.push_back({FLSharedKeys_Retain(sharedKeys), path});
+    return path;
+}
+
+- (nullable id) evaluateObject: (nullable id)root {
+    id current = root;
+    for (id component in _components) {
+        if ([component isKindOfClass: [NSString class]])
+            current = childForKey(current, component);
+        else
+            current = childAtIndex(current, [component integerValue]);
+        if (!current)
+            break;
+    }
+    return current;
+}
+
+static id childForKey(id container, NSString* key) {
+    if ([container conformsToProtocol: @protocol(CBLDictionary)])
+        return [container valueForKey: key];
+    else if ([container isKindOfClass: [NSDictionary class]])
+        return [container objectForKey: key];
+    return nil;
+}
+
+static id childAtIndex(id container, NSInteger index) {
+    BOOL isCBLArray = [container conformsToProtocol: @protocol(CBLArray)];
+    if (!isCBLArray && ![container isKindOfClass: [NSArray class]])
+        return nil;
+    NSInteger count = (NSInteger)[container count];
+    if (index < 0)
+        index += count;
+    if (index < 0 || index >= count)
+        return nil;
+    return isCBLArray ? [container valueAtIndex: index] : [container objectAtIndex: index];
+}
+
+#pragma mark - Parsing
+
+static id invalidPath(NSString* path, NSString* problem, NSError** outError) {
+    NSString* desc = [NSString stringWithFormat: @"Invalid key path '%@': %@", path, problem];
+    createError(CBLErrorInvalidParameter, desc, outError);
+    return nil;
+}
+
+// Splits a path into keys and indexes. Also returns the part of the path after the first
+// component, or nil if there's only one component.
+static NSArray* parseKeyPath(NSString* path, NSString** outTail, NSError** outError) {
+    NSUInteger n = path.length, i = 0;
+    if (n > 0 && [path characterAtIndex: 0] == '$') {
+        i = 1;
+        if (i < n && [path characterAtIndex: i] == '.')
+            i++;
+    }
+    if (i == n)
+        return invalidPath(path, @"the path is empty", outError);
+    
+    NSMutableArray* components = [NSMutableArray array];
+    *outTail = nil;
+    while (i < n) {
+        unichar c = [path characterAtIndex: i];
+        if (c == '[') {
+            NSUInteger start = ++i;
+            if (i < n && [path characterAtIndex: i] == '-')
+                i++;
+            while (i < n && isdigit([path characterAtIndex: i]))
+                i++;
+            if (i == start || (i == start + 1 && [path characterAtIndex: start] == '-')
+                    || i == n || [path characterAtIndex: i] != ']')
+                return invalidPath(path, @"an array index must be an integer in brackets", outError);
+            [components addObject: @([path substringWithRange: NSMakeRange(start, i - start)].integerValue)];
+            i++;
+            if (i < n && [path characterAtIndex: i] != '.' && [path characterAtIndex: i] != '[')
+                return invalidPath(path, @"an array index must be followed by '.' or '['", outError);
+        } else {
+            NSMutableString* key = [NSMutableString string];
+            while (i < n && (c = [path characterAtIndex: i]) != '.' && c != '[') {
+                if (c == '\\') {
+                    if (++i == n)
+                        return invalidPath(path, @"the path ends with a backslash", outError);
+                    c = [path characterAtIndex: i];
+                }
+                [key appendFormat: @"%C", c];
+                i++;
+            }
+            if (key.length == 0)
+                return invalidPath(path, @"a key is empty", outError);
+            [components addObject: key];
+        }
+        
+        if (components.count == 1 && i < n) {
+            NSUInteger tailStart = ([path characterAtIndex: i] == '.') ? i + 1 : i;
+            *outTail = [path substringFromIndex: tailStart];
+        }
+        if (i < n && [path characterAtIndex: i] == '.') {
+            if (++i == n)
+                return invalidPath(path, @"the path ends with a period", outError);
+        }
+    }
+    return components;
+}
+
+@end
+
+CBLKeyPath* CBLKeyPathForString(NSString* path) {
+    CBLAssertNotNil(path);
+    
+    static NSCache<NSString*, CBLKeyPath*>* sCache;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sCache = [NSCache new];
+        sCache.countLimit = 100;
+    });
+    
+    CBLKeyPath* keyPath = [sCache objectForKey: path];
+    if (!keyPath) {
+        NSError* error;
+        keyPath = [[CBLKeyPath alloc] initWithString: path error: &error];
+        if (!keyPath)
+            [NSException raise: NSInvalidArgumentException format: @"%@", error.localizedDescription];
+        [sCache setObject: keyPath forKey: path];
+    }
+    return keyPath;
+}
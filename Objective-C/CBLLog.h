@@ -39,6 +39,26 @@ NS_ASSUME_NONNULL_BEGIN
  the custom logger to be reassigned so that the change can be affected. */
 @property (nonatomic, nullable) id<CBLLogger> custom;
 
+/** If YES, log messages for the console and custom loggers are queued and delivered on a
+ background thread, so that a slow custom logger never blocks the thread that logged. When the
+ queue is full, new messages are dropped rather than waited for, and counted in
+ droppedMessageCount. File logging is not affected. The default value is NO. */
+@property (nonatomic) BOOL asynchronous;
+
+/** The number of log messages dropped in asynchronous mode because the queue was full. */
+@property (readonly, nonatomic) uint64_t droppedMessageCount;
+
+/** If YES, Couchbase Lite records timing events (document saves, query execution, WebSocket
+ reads and writes, replicator status changes) into in-memory per-thread buffers, which keep the
+ most recent events. Recording is cheap enough to leave on while reproducing a latency problem;
+ when disabled it costs next to nothing. Use -exportTrace to get the events. The default value
+ is NO. */
+@property (nonatomic) BOOL tracingEnabled;
+
+/** Returns the events recorded while tracing was enabled, as JSON in the Chrome trace event
+ format, which can be loaded into chrome://tracing or Perfetto. */
+- (NSData*) exportTrace;
+
 /** Not available */
 - (instancetype) init NS_UNAVAILABLE;
 
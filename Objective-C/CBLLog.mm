@@ -22,7 +22,14 @@
 #import "CBLLog+Internal.h"
 #import "CBLLog+Logging.h"
 #import "CBLLog+Swift.h"
+#import "CBLLock.h"
+#import "CBLRingBuffer.hh"
 #import "CBLStringBytes.h"
+#import "CBLTrace.hh"
+#import <algorithm>
+#import <atomic>
+#import <memory>
+#import <mutex>
 
 extern "C" {
 #import "ExceptionUtils.h"
@@ -34,8 +41,44 @@ C4LogDomain kCBL_LogDomainSync;
 C4LogDomain kCBL_LogDomainWebSocket;
 C4LogDomain kCBL_LogDomainListener;
 
+// These start out fully enabled so that anything logged before CBLLog is initialized gets to
+// cblLog(), which initializes it and then checks the actual levels:
+C4LogLevel kCBL_LogLevelDefault   = kC4LogDebug;
+C4LogLevel kCBL_LogLevelDatabase  = kC4LogDebug;
+C4LogLevel kCBL_LogLevelQuery     = kC4LogDebug;
+C4LogLevel kCBL_LogLevelSync      = kC4LogDebug;
+C4LogLevel kCBL_LogLevelWebSocket = kC4LogDebug;
+C4LogLevel kCBL_LogLevelListener  = kC4LogDebug;
+
 static const char* kLevelNames[6] = {"Debug", "Verbose", "Info", "WARNING", "ERROR", "none"};
 
+#ifdef COUCHBASE_ENTERPRISE
+static const CBLLogDomain kListenerCBLLogDomain = kCBLLogDomainListener;
+#else
+static const CBLLogDomain kListenerCBLLogDomain = kCBLLogDomainDatabase;
+#endif
+
+// Mapping of LiteCore log domains to CBLLogDomain, filled in once when CBLLog is initialized:
+static constexpr unsigned kMaxMappedDomains = 16;
+static C4LogDomain sMappedC4Domains[kMaxMappedDomains];
+static CBLLogDomain sMappedCBLDomains[kMaxMappedDomains];
+static unsigned sMappedDomainCount = 0;
+
+// Value of the CBLBreakOnWarning user default, read once when CBLLog is initialized:
+static BOOL sBreakOnWarning = NO;
+
+// Max number of messages waiting for the log thread in asynchronous mode:
+static constexpr size_t kLogQueueCapacity = 4096;
+
+namespace {
+    // A message waiting for the log thread:
+    struct LogEntry {
+        CBLLogLevel level;
+        CBLLogDomain domain;
+        CFTypeRef message;      // Retained NSString
+    };
+}
+
 // For bridging custom logger between Swift and Objective-C
 // without making CBLLogger protocol public
 @interface CBLCustomLogger : NSObject <CBLLogger>
@@ -44,6 +87,14 @@ static const char* kLevelNames[6] = {"Debug", "Verbose", "Info", "WARNING", "ERR
 
 @implementation CBLLog {
     CBLLogLevel _callbackLogLevel;
+    std::atomic<bool> _asynchronous;        // Set with release order, after _logQueue exists
+    std::unique_ptr<cbl::RingBuffer<LogEntry>> _logQueue;
+    dispatch_semaphore_t _logQueueSignal;
+    NSThread* _logThread;
+    std::atomic<bool> _flushRequested;      // Asks the log thread to signal _logQueueFlushed
+    dispatch_semaphore_t _logQueueFlushed;
+    std::mutex _flushMutex;                 // One flush at a time
+    std::atomic<uint64_t> _droppedMessageCount;
 }
 
 @synthesize console=_console, file=_file, custom=_custom;
@@ -69,36 +120,36 @@ static C4LogLevel string2level(NSString* value) {
     }
 }
 
-static C4LogDomain setNamedLogDomainLevel(const char *domainName, C4LogLevel level) {
+static C4LogDomain setNamedLogDomainLevel(const char *domainName, C4LogLevel level,
+                                          CBLLogDomain cblDomain)
+{
     C4LogDomain domain = c4log_getDomain(domainName, true);
-    if (domain)
+    if (domain) {
         c4log_setLevel(domain, level);
+        if (sMappedDomainCount < kMaxMappedDomains) {
+            sMappedC4Domains[sMappedDomainCount] = domain;
+            sMappedCBLDomains[sMappedDomainCount] = cblDomain;
+            sMappedDomainCount++;
+        }
+    }
     return domain;
 }
 
-static NSDictionary* domainDictionary = nil;
+// A message is written if its domain's level allows it and either the file log or the
+// callback (console and custom) loggers want it:
+static C4LogLevel effectiveLogLevel(C4LogDomain domain, C4LogLevel callbackLevel) {
+    if (!domain)
+        return kC4LogNone;
+    C4LogLevel sinkLevel = std::min(c4log_binaryFileLevel(), callbackLevel);
+    return std::max(c4log_getLevel(domain), sinkLevel);
+}
 
 static CBLLogDomain toCBLLogDomain(C4LogDomain domain) {
-    if (!domainDictionary) {
-        domainDictionary = @{ @"DB": @(kCBLLogDomainDatabase),
-                              @"Query": @(kCBLLogDomainQuery),
-                              @"Sync": @(kCBLLogDomainReplicator),
-                              @"SyncBusy": @(kCBLLogDomainReplicator),
-                              @"Changes": @(kCBLLogDomainReplicator),
-                              @"BLIP": @(kCBLLogDomainNetwork),
-                              @"WS": @(kCBLLogDomainNetwork),
-                              @"BLIPMessages": @(kCBLLogDomainNetwork),
-                              @"Zip": @(kCBLLogDomainNetwork),
-                              @"TLS": @(kCBLLogDomainNetwork),
-#ifdef COUCHBASE_ENTERPRISE
-                              @"Listener": @(kCBLLogDomainListener)
-#endif
-        };
+    for (unsigned i = 0; i < sMappedDomainCount; i++) {
+        if (sMappedC4Domains[i] == domain)
+            return sMappedCBLDomains[i];
     }
-    
-    NSString* domainName = [NSString stringWithUTF8String: c4log_getDomainName(domain)];
-    NSNumber* mapped = [domainDictionary objectForKey: domainName];
-    return mapped ? mapped.integerValue : kCBLLogDomainDatabase;
+    return kCBLLogDomainDatabase;
 }
 
 static void logCallback(C4LogDomain domain, C4LogLevel level, const char *fmt, va_list args) {
@@ -116,25 +167,43 @@ static void sendToCallbackLogger(C4LogDomain d, C4LogLevel l, NSString* message)
     
     // Level:
     CBLLogLevel level = (CBLLogLevel)l;
-    BOOL shouldLogToConsole = level >= log.console.level;
-    BOOL shouldLogToCustom = log.custom && level >= log.custom.level;
-    if (!shouldLogToConsole && !shouldLogToCustom)
-        return;
-    
-    // Domain:
-    CBLLogDomain domain = toCBLLogDomain(d);
+    if (level >= log->_callbackLogLevel) {
+        if (log->_asynchronous.load(std::memory_order_acquire))
+            enqueueLogMessage(log, level, toCBLLogDomain(d), message);
+        else
+            writeToCallbackLogger(log, level, toCBLLogDomain(d), message);
+    }
     
+    // Breakpoint if enabled:
+    if (level >= kCBLLogLevelWarning && sBreakOnWarning)
+        MYBreakpoint();     // stops debugger at breakpoint. You can resume normally.
+}
+
+static void writeToCallbackLogger(CBLLog* log, CBLLogLevel level, CBLLogDomain domain,
+                                  NSString* message)
+{
     // Console log:
-    if (shouldLogToConsole)
-        [log.console logWithLevel: level domain: domain message: message];
+    CBLConsoleLogger* console = log.console;
+    if (level >= console.level)
+        [console logWithLevel: level domain: domain message: message];
     
     // Custom log:
-    if (shouldLogToCustom)
-        [log.custom logWithLevel: level domain: domain message: message];
-    
-    // Breakpoint if enabled:
-    if (level >= kCBLLogLevelWarning && [NSUserDefaults.standardUserDefaults boolForKey: @"CBLBreakOnWarning"])
-        MYBreakpoint();     // stops debugger at breakpoint. You can resume normally.
+    id<CBLLogger> custom = log.custom;
+    if (custom && level >= custom.level)
+        [custom logWithLevel: level domain: domain message: message];
+}
+
+static void enqueueLogMessage(CBLLog* log, CBLLogLevel level, CBLLogDomain domain,
+                              NSString* message)
+{
+    // Never wait for the log thread; if it's fallen too far behind, drop the message:
+    LogEntry entry {level, domain, CFBridgingRetain(message)};
+    if (log->_logQueue->push(entry)) {
+        dispatch_semaphore_signal(log->_logQueueSignal);
+    } else {
+        CFRelease(entry.message);
+        ++log->_droppedMessageCount;
+    }
 }
 
 // Initialize the CBLLog object and register the logging callback.
@@ -162,35 +231,51 @@ static void sendToCallbackLogger(C4LogDomain d, C4LogLevel l, NSString* message)
         if (callbackLogLevel != kC4LogWarning)
             NSLog(@"CouchbaseLite minimum log level is %s", kLevelNames[callbackLogLevel]);
         
-        // Set log level for each domains to the lowest:
-        kCBL_LogDomainDatabase  = setNamedLogDomainLevel("DB", kC4LogDebug);
-        kCBL_LogDomainQuery     = setNamedLogDomainLevel("Query", kC4LogDebug);
-        kCBL_LogDomainSync      = setNamedLogDomainLevel("Sync", kC4LogDebug);
-        kCBL_LogDomainWebSocket = setNamedLogDomainLevel("WS", kC4LogDebug);
-        kCBL_LogDomainListener  = setNamedLogDomainLevel("Listener", kC4LogDebug);
-        setNamedLogDomainLevel("BLIP", kC4LogDebug);
-        setNamedLogDomainLevel("SyncBusy", kC4LogDebug);
-        setNamedLogDomainLevel("TLS", kC4LogDebug);
-        setNamedLogDomainLevel("Changes", kC4LogDebug);
-        setNamedLogDomainLevel("Zip", kC4LogDebug);
-        setNamedLogDomainLevel("BLIPMessages", kC4LogDebug);
+        // Set log level for each domains to the lowest, and map them to CBLLogDomains:
+        kCBL_LogDomainDatabase  = setNamedLogDomainLevel("DB", kC4LogDebug, kCBLLogDomainDatabase);
+        kCBL_LogDomainQuery     = setNamedLogDomainLevel("Query", kC4LogDebug, kCBLLogDomainQuery);
+        kCBL_LogDomainSync      = setNamedLogDomainLevel("Sync", kC4LogDebug, kCBLLogDomainReplicator);
+        kCBL_LogDomainWebSocket = setNamedLogDomainLevel("WS", kC4LogDebug, kCBLLogDomainNetwork);
+        kCBL_LogDomainListener  = setNamedLogDomainLevel("Listener", kC4LogDebug, kListenerCBLLogDomain);
+        setNamedLogDomainLevel("BLIP", kC4LogDebug, kCBLLogDomainNetwork);
+        setNamedLogDomainLevel("SyncBusy", kC4LogDebug, kCBLLogDomainReplicator);
+        setNamedLogDomainLevel("TLS", kC4LogDebug, kCBLLogDomainNetwork);
+        setNamedLogDomainLevel("Changes", kC4LogDebug, kCBLLogDomainReplicator);
+        setNamedLogDomainLevel("Zip", kC4LogDebug, kCBLLogDomainNetwork);
+        setNamedLogDomainLevel("BLIPMessages", kC4LogDebug, kCBLLogDomainNetwork);
+        
+        sBreakOnWarning = [NSUserDefaults.standardUserDefaults boolForKey: @"CBLBreakOnWarning"];
         
-        // Now map user defaults starting with CBLLog... to log levels:
-        NSDictionary* defaults = [NSUserDefaults.standardUserDefaults dictionaryRepresentation];
-        for (NSString* key in defaults) {
-            if ([key hasPrefix: @"CBLLog"] && ![key isEqualToString: @"CBLLogLevel"]) {
-                const char *domainName = key.UTF8String + 6;
-                if (*domainName == 0)
-                    domainName = "Default";
-                C4LogDomain domain = c4log_getDomain(domainName, true);
-                C4LogLevel level = string2level(defaults[key]);
-                c4log_setLevel(domain, level);
-                NSLog(@"CouchbaseLite logging to %s domain at level %s", domainName, kLevelNames[level]);
+        // Now map user defaults starting with CBLLog... to log levels. Only the command-line
+        // arguments, the app's own defaults and the registered defaults are searched:
+        // -dictionaryRepresentation merges every domain (including NSGlobalDomain) and is too
+        // costly at startup. A key can be in more than one domain; -objectForKey: resolves it to
+        // the winning value, so each key is applied only once.
+        NSUserDefaults* userDefaults = NSUserDefaults.standardUserDefaults;
+        NSString* bundleID = NSBundle.mainBundle.bundleIdentifier;
+        NSDictionary* arguments = [userDefaults volatileDomainForName: NSArgumentDomain];
+        NSDictionary* appDefaults = bundleID ? [userDefaults persistentDomainForName: bundleID] : nil;
+        NSDictionary* registered = [userDefaults volatileDomainForName: NSRegistrationDomain];
+        NSMutableSet<NSString*>* logKeys = [NSMutableSet set];
+        for (NSDictionary* defaults in @[arguments ?: @{}, appDefaults ?: @{}, registered ?: @{}]) {
+            for (NSString* key in defaults) {
+                if ([key hasPrefix: @"CBLLog"] && ![key isEqualToString: @"CBLLogLevel"])
+                    [logKeys addObject: key];
             }
         }
+        for (NSString* key in logKeys) {
+            const char *domainName = key.UTF8String + 6;
+            if (*domainName == 0)
+                domainName = "Default";
+            C4LogDomain domain = c4log_getDomain(domainName, true);
+            C4LogLevel level = string2level([userDefaults objectForKey: key]);
+            c4log_setLevel(domain, level);
+            NSLog(@"CouchbaseLite logging to %s domain at level %s", domainName, kLevelNames[level]);
+        }
         
         // Keep the current callback log level:
         _callbackLogLevel = (CBLLogLevel)callbackLogLevel;
+        [self updateEffectiveLogLevels];
         
         // Create console logger:
         _console = [[CBLConsoleLogger alloc] initWithLogLevel: _callbackLogLevel];
@@ -208,6 +293,43 @@ static void sendToCallbackLogger(C4LogDomain d, C4LogLevel l, NSString* message)
     [self synchronizeCallbackLogLevel];
 }
 
+- (BOOL) asynchronous {
+    return _asynchronous;
+}
+
+- (void) setAsynchronous: (BOOL)asynchronous {
+    BOOL hasLogThread;
+    CBL_LOCK(self) {
+        if (asynchronous && !_logQueue)
+            [self startLogThread];
+        // The release pairs with the acquire in sendToCallbackLogger(), so a thread that sees
+        // the flag set also sees the queue created by -startLogThread:
+        _asynchronous.store(asynchronous, std::memory_order_release);
+        hasLogThread = (_logQueue != nullptr);
+    }
+    
+    // Wait for the log thread to deliver whatever is still queued, so that the messages logged
+    // from now on come after it:
+    if (!asynchronous && hasLogThread)
+        [self flushLogQueue];
+}
+
+- (uint64_t) droppedMessageCount {
+    return _droppedMessageCount;
+}
+
+- (BOOL) tracingEnabled {
+    return cbl::tracingEnabled();
+}
+
+- (void) setTracingEnabled: (BOOL)tracingEnabled {
+    cbl::setTracingEnabled(tracingEnabled);
+}
+
+- (NSData*) exportTrace {
+    return cbl::exportChromeTrace();
+}
+
 #pragma mark - Internal
 
 + (instancetype) sharedInstance {
@@ -228,6 +350,70 @@ static void sendToCallbackLogger(C4LogDomain d, C4LogLevel l, NSString* message)
     if (syncLogLevel != _callbackLogLevel) {
         c4log_setCallbackLevel((C4LogLevel)syncLogLevel);
         _callbackLogLevel = syncLogLevel;
+        [self updateEffectiveLogLevels];
+    }
+}
+
+- (void) updateEffectiveLogLevels {
+    C4LogLevel callbackLevel = (C4LogLevel)_callbackLogLevel;
+    kCBL_LogLevelDefault   = effectiveLogLevel(kC4DefaultLog, callbackLevel);
+    kCBL_LogLevelDatabase  = effectiveLogLevel(kCBL_LogDomainDatabase, callbackLevel);
+    kCBL_LogLevelQuery     = effectiveLogLevel(kCBL_LogDomainQuery, callbackLevel);
+    kCBL_LogLevelSync      = effectiveLogLevel(kCBL_LogDomainSync, callbackLevel);
+    kCBL_LogLevelWebSocket = effectiveLogLevel(kCBL_LogDomainWebSocket, callbackLevel);
+    kCBL_LogLevelListener  = effectiveLogLevel(kCBL_LogDomainListener, callbackLevel);
+}
+
+- (BOOL) shouldLogToCallback: (CBLLogLevel)level {
+    return level >= _callbackLogLevel;
+}
+
+#pragma mark - Log Thread
+
+- (void) startLogThread {
+    _logQueue.reset(new cbl::RingBuffer<LogEntry>(kLogQueueCapacity));
+    _logQueueSignal = dispatch_semaphore_create(0);
+    _logQueueFlushed = dispatch_semaphore_create(0);
+    
+    _logThread = [[NSThread alloc] initWithTarget: self
+                                         selector: @selector(runLogThread)
+                                           object: nil];
+    _logThread.name = @"CouchbaseLite Logging";
+    _logThread.qualityOfService = NSQualityOfServiceUtility;
+    [_logThread start];
+}
+
+- (void) runLogThread {
+    for (;;) {
+        dispatch_semaphore_wait(_logQueueSignal, DISPATCH_TIME_FOREVER);
+        [self drainLogQueue];
+        if (_flushRequested.exchange(false)) {
+            [self drainLogQueue];   // Catch messages pushed after the first drain finished
+            dispatch_semaphore_signal(_logQueueFlushed);
+        }
+    }
+}
+
+// Has the log thread deliver the queued messages, and waits for it. Only the log thread ever
+// drains the queue, so messages are delivered in order.
+- (void) flushLogQueue {
+    if ([NSThread currentThread] == _logThread) {
+        // Called by a logger; the log thread is already delivering the messages.
+        return;
+    }
+    std::lock_guard<std::mutex> lock(_flushMutex);
+    _flushRequested = true;
+    dispatch_semaphore_signal(_logQueueSignal);
+    dispatch_semaphore_wait(_logQueueFlushed, DISPATCH_TIME_FOREVER);
+}
+
+- (void) drainLogQueue {
+    LogEntry entry;
+    while (_logQueue->pop(entry)) {
+        @autoreleasepool {
+            NSString* message = CFBridgingRelease(entry.message);
+            writeToCallbackLogger(self, entry.level, entry.domain, message);
+        }
     }
 }
 
@@ -266,15 +452,27 @@ static void sendToCallbackLogger(C4LogDomain d, C4LogLevel l, NSString* message)
 @end
 
 void cblLog(C4LogDomain domain, C4LogLevel level, NSString *msg, ...) {
-    // Send preformatted message to litecore no-callback log:
+    // Find out who wants the message before paying for formatting it:
+    CBLLog* log = [CBLLog sharedInstance];
+    bool toFile = domain && level >= c4log_binaryFileLevel() && level >= c4log_getLevel(domain);
+    bool toCallback = [log shouldLogToCallback: (CBLLogLevel)level];
+    if (!toFile && !toCallback)
+        return;
+    
     va_list args;
     va_start(args, msg);
     NSString *nsmsg = [[NSString alloc] initWithFormat: msg arguments: args];
-    CBLStringBytes c4msg(nsmsg);
-    c4slog(domain, level, c4msg);
+    va_end(args);
+    
+    // Send preformatted message to litecore no-callback log:
+    if (toFile) {
+        CBLStringBytes c4msg(nsmsg);
+        c4slog(domain, level, c4msg);
+    }
     
     // Now log to console and custom logger:
-    sendToCallbackLogger(domain, level, nsmsg);
+    if (toCallback)
+        sendToCallbackLogger(domain, level, nsmsg);
 }
 
 NSString* CBLLog_GetLevelName(CBLLogLevel level) {
@@ -0,0 +1,51 @@
+//
+//  CBLMaintenanceTask.h
+//  CouchbaseLite
+//
+//  Copyright (c) 2022 Couchbase, Inc All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import <Foundation/Foundation.h>
+#import "CBLDatabase.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A database maintenance operation running in the background, as started by
+ -[CBLDatabase performIncrementalMaintenance:timeSlice:queue:progress:completion:].
+ */
+@interface CBLMaintenanceTask : NSObject
+
+/** The maintenance type. */
+@property (readonly, nonatomic) CBLMaintenanceType type;
+
+/** The fraction of the work done so far, from 0.0 to 1.0. */
+@property (readonly, atomic) double progress;
+
+/** Whether the task has been cancelled. */
+@property (readonly, atomic) BOOL isCancelled;
+
+/**
+ Cancels the task. It stops before its next step, and its completion handler is called with an
+ NSUserCancelledError error. The work done by the steps already completed is kept.
+ */
+- (void) cancel;
+
+/** Not available */
+- (instancetype) init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,243 @@
+//
+//  CBLMaintenanceTask.mm
+//  CouchbaseLite
+//
+//  Copyright (c) 2022 Couchbase, Inc All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import "CBLMaintenanceTask+Internal.h"
+#import "CBLCoreBridge.h"
+#import "CBLDatabase+Internal.h"
+#import "CBLStatus.h"
+#import "CBLStringBytes.h"
+#import "c4Private.h"
+#import "fleece/Fleece.hh"
+#import <atomic>
+
+using namespace fleece;
+
+// Free pages released by each `PRAGMA incremental_vacuum` step:
+static const int kVacuumPagesPerStep = 256;
+
+@implementation CBLMaintenanceTask
+{
+    CBLDatabase* _db;
+    NSTimeInterval _timeSlice;
+    dispatch_queue_t _queue;
+    void (^_progressHandler)(double);
+    void (^_completion)(NSError*);
+    
+    std::atomic<bool> _cancelled;
+    std::atomic<double> _progress;
+    
+    BOOL _started;                          // Has the first step run?
+    BOOL _incremental;                      // False if there's nothing to do
+    int64_t _initialFreePages;              // Compact: free pages when the task started
+    NSArray<NSString*>* _indexes;           // FullOptimize: SQLite indexes to analyze
+    NSUInteger _nextIndex;                  // FullOptimize: next index to analyze
+}
+
+@synthesize type=_type;
+
+- (instancetype) initWithDatabase: (CBLDatabase*)database
+                             type: (CBLMaintenanceType)type
+                        timeSlice: (NSTimeInterval)timeSlice
+                            queue: (dispatch_queue_t)queue
+                         progress: (nullable void (^)(double progress))progress
+                       completion: (void (^)(NSError* _Nullable error))completion
+{
+    self = [super init];
+    if (self) {
+        _db = database;
+        _type = type;
+        _timeSlice = timeSlice;
+        _queue = queue;
+        _progressHandler = progress;
+        _completion = completion;
+        _cancelled = false;
+        _progress = 0.0;
+    }
+    return self;
+}
+
+- (NSString*) description {
+    return [NSString stringWithFormat: @"%@[%p type=%u]", self.class, self, (unsigned)_type];
+}
+
+- (double) progress {
+    return _progress;
+}
+
+- (BOOL) isCancelled {
+    return _cancelled;
+}
+
+- (void) cancel {
+    _cancelled = true;
+}
+
+- (void) stop {
+    [self cancel];
+}
+
+#pragma mark - Steps
+
+- (void) start {
+    CBLLogInfo(Database, @"%@: Starting incremental maintenance of %@", self, _db);
+    [self scheduleNextSlice];
+}
+
+- (void) scheduleNextSlice {
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+        [self runSlice];
+    });
+}
+
+// Runs steps while holding the database lock, until the time slice is used up, then releases
+// the lock and reschedules itself.
+- (void) runSlice {
+    NSError* error = nil;
+    BOOL done = NO;
+    CBL_LOCK(_db.mutex) {
+        if (_cancelled) {
+            error = [NSError errorWithDomain: NSCocoaErrorDomain code: NSUserCancelledError
+                                    userInfo: nil];
+        } else if (_db.isClosedLocked) {
+            createError(CBLErrorNotOpen, &error);
+        } else {
+            CFAbsoluteTime deadline = CFAbsoluteTimeGetCurrent() + _timeSlice;
+            do {
+                done = ![self step: &error];
+            } while (!done && !_cancelled && CFAbsoluteTimeGetCurrent() < deadline);
+        }
+    }
+    
+    if (done || error) {
+        [self finish: error];
+        return;
+    }
+    
+    if (_progressHandler) {
+        double progress = _progress;
+        dispatch_async(_queue, ^{
+            self->_progressHandler(progress);
+        });
+    }
+    [self scheduleNextSlice];
+}
+
+// Does one bounded unit of work. Returns NO when there's nothing left to do or on error.
+- (BOOL) step: (NSError**)outError {
+    C4Database* c4db = _db.c4db;
+    if (!_started) {
+        _started = YES;
+        if (![self prepare: c4db error: outError] || !_incremental)
+            return NO;
+    }
+    
+    if (_type == kCBLMaintenanceTypeCompact) {
+        int64_t freePages;
+        if (!runSQL(c4db, $sprintf(@"PRAGMA incremental_vacuum(%d)", kVacuumPagesPerStep),
+                    nullptr, outError)
+                || !runSQL(c4db, @"PRAGMA freelist_count", &freePages, outError))
+            return NO;
+        _progress = 1.0 - (double)freePages / _initialFreePages;
+        return freePages > 0;
+    } else {
+        if (_nextIndex < _indexes.count) {
+            NSString* index = _indexes[_nextIndex++];
+            NSString* sql = $sprintf(@"ANALYZE \"%@\"",
+                                     [index stringByReplacingOccurrencesOfString: @"\""
+                                                                      withString: @"\"\""]);
+            if (!runSQL(c4db, sql, nullptr, outError))
+                return NO;
+        }
+        _progress = (double)_nextIndex / _indexes.count;
+        return _nextIndex < _indexes.count;
+    }
+}
+
+// Works out how much there is to do. Fails with CBLErrorUnsupported if the work can't be split
+// into steps, since running it in one step would hold the lock for as long as it takes.
+- (BOOL) prepare: (C4Database*)c4db error: (NSError**)outError {
+    if (_type == kCBLMaintenanceTypeCompact) {
+        // Free pages can only be reclaimed one step at a time in incremental auto-vacuum mode:
+        int64_t autoVacuum;
+        if (!runSQL(c4db, @"PRAGMA auto_vacuum", &autoVacuum, outError))
+            return NO;
+        if (autoVacuum == 2) {
+            if (!runSQL(c4db, @"PRAGMA freelist_count", &_initialFreePages, outError))
+                return NO;
+            _incremental = (_initialFreePages > 0);
+            if (!_incremental)
+                _progress = 1.0;
+            return YES;
+        }
+    } else if (_type == kCBLMaintenanceTypeFullOptimize) {
+        // ANALYZE each index on its own instead of the whole database at once:
+        alloc_slice rows;
+        if (!rawQuery(c4db, @"SELECT name FROM sqlite_master WHERE type='index'", &rows, outError))
+            return NO;
+        NSMutableArray* indexes = [NSMutableArray array];
+        for (Array::iterator i(Value(FLValue_FromData(rows, kFLTrusted)).asArray()); i; ++i) {
+            NSString* name = slice2string(i.value().asArray()[0].asString());
+            if (name)
+                [indexes addObject: name];
+        }
+        _indexes = indexes;
+        _incremental = (indexes.count > 0);
+        return YES;
+    }
+    CBLWarn(Database, @"%@: Maintenance type can't be done incrementally", self);
+    return createError(CBLErrorUnsupported,
+                       @"This maintenance type can't be done incrementally; "
+                       "use -performMaintenance:error: instead", outError);
+}
+
+- (void) finish: (NSError*)error {
+    if (!error)
+        _progress = 1.0;
+    CBLLogInfo(Database, @"%@: Finished incremental maintenance of %@, error=%@", self, _db, error);
+    [_db removeActiveStoppable: self];
+    _db = nil;
+    
+    void (^completion)(NSError*) = _completion;
+    _completion = nil;
+    dispatch_async(_queue, ^{
+        completion(error);
+    });
+}
+
+#pragma mark - SQL
+
+// Runs a SQL statement directly on the SQLite database, returning the Fleece-encoded rows.
+static BOOL rawQuery(C4Database* c4db, NSString* sql, alloc_slice* outRows, NSError** outError) {
+    C4Error err = {};
+    CBLStringBytes sqlBytes(sql);
+    *outRows = alloc_slice(c4db_rawQuery(c4db, sqlBytes, &err));
+    return *outRows || err.code == 0 || convertError(err, outError);
+}
+
+// Runs a SQL statement, optionally returning the integer in the first column of the first row.
+static BOOL runSQL(C4Database* c4db, NSString* sql, int64_t* outValue, NSError** outError) {
+    alloc_slice rows;
+    if (!rawQuery(c4db, sql, &rows, outError))
+        return NO;
+    if (outValue)
+        *outValue = Value(FLValue_FromData(rows, kFLTrusted)).asArray()[0].asArray()[0].asInt();
+    return YES;
+}
+
+@end
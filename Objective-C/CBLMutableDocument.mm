@@ -32,6 +32,9 @@
 using namespace fleece;
 
 @implementation CBLMutableDocument
+{
+    BOOL _contentReplaced;      // Content was replaced by setJSON:
+}
 
 #pragma mark - Initializer
 
@@ -171,7 +174,10 @@ using namespace fleece;
 }
 
 - (BOOL) setJSON: (NSString*)json error: (NSError**)error {
-    return [((CBLMutableDictionary*)_dict) setJSON: json error: error];
+    if (![self setContentWithJSON: json error: error])
+        return NO;
+    _contentReplaced = YES;
+    return YES;
 }
 
 - (NSString*) toJSON {
@@ -205,7 +211,7 @@ using namespace fleece;
 
 // TODO: Need to be reset after the document is saved.
 - (BOOL) changed {
-    return ((CBLMutableDictionary*)_dict).changed;
+    return _contentReplaced || ((CBLMutableDictionary*)_dict).changed;
 }
 
 @end
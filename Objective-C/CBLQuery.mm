@@ -34,6 +34,7 @@
 #import "CBLStringBytes.h"
 #import "CBLChangeNotifier.h"
 #import "CBLQueryObserver.h"
+#import "CBLTrace.hh"
 
 using namespace fleece;
 
@@ -254,6 +255,7 @@ using namespace fleece;
 }
 
 - (nullable CBLQueryResultSet*) execute: (NSError**)outError {
+    cbl::TraceSpan span(cbl::TraceEvent::QueryExecuteBegin, cbl::TraceEvent::QueryExecuteEnd);
     C4QueryOptions options = kC4DefaultQueryOptions;
     
     __block C4QueryEnumerator* e;
@@ -261,6 +263,7 @@ using namespace fleece;
     [self.database safeBlock:^{
         e = c4query_run(_c4Query, &options, kC4SliceNull, &c4Err);
     }];
+    span.setResult(e != nullptr);
     
     if (!e) {
         CBLWarnError(Query, @"CBLQuery failed: %d/%d", c4Err.domain, c4Err.code);
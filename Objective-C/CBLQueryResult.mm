@@ -22,6 +22,7 @@
 #import "CBLDatabase+Internal.h"
 #import "CBLDocument+Internal.h"
 #import "CBLJSON.h"
+#import "CBLKeyPath+Internal.h"
 #import "CBLPropertyExpression.h"
 #import "CBLQueryResultSet+Internal.h"
 #import "MRoot.hh"
@@ -92,7 +93,7 @@ using namespace fleece;
 }
 
 - (nullable NSDate*) dateAtIndex: (NSUInteger)index {
-    return asDate([self fleeceValueToObjectAtIndex: index]);
+    return dateFromFleece([self fleeceValueAtIndex: index]);
 }
 
 - (nullable CBLBlob*) blobAtIndex: (NSUInteger)index {
@@ -236,6 +237,33 @@ using namespace fleece;
     return index >= 0;
 }
 
+- (nullable id) valueAtKeyPath: (NSString*)path {
+    return [self valueAtCompiledKeyPath: CBLKeyPathForString(path)];
+}
+
+- (nullable id) valueAtCompiledKeyPath: (CBLKeyPath*)keyPath {
+    CBLAssertNotNil(keyPath);
+    
+    // The first path component picks the column, by name or by index:
+    NSInteger index;
+    if (NSString* key = keyPath.firstKey) {
+        index = [self indexForColumnName: key];
+    } else {
+        NSInteger count = (NSInteger)self.count;
+        index = keyPath.firstIndex;
+        if (index < 0)
+            index += count;
+        if (index >= count)
+            index = -1;
+    }
+    if (index < 0)
+        return nil;
+    
+    FLValue value = [keyPath evaluateFleeceAfterFirst: [self fleeceValueAtIndex: index]
+                                           sharedKeys: _rs.database.sharedKeys];
+    return [self fleeceValueToObject: value];
+}
+
 - (NSDictionary<NSString*,id>*) toDictionary {
     NSMutableDictionary* dict = [NSMutableDictionary dictionary];
     for (NSString* name in _rs.columnNames) {
@@ -287,7 +315,10 @@ using namespace fleece;
 }
 
 - (id) fleeceValueToObjectAtIndex: (NSUInteger)index {
-    FLValue value = [self fleeceValueAtIndex: index];
+    return [self fleeceValueToObject: [self fleeceValueAtIndex: index]];
+}
+
+- (id) fleeceValueToObject: (FLValue)value {
     if (value == nullptr || FLValue_GetType(value) == kFLNull)
         return nil;
     
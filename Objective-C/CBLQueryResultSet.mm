@@ -28,6 +28,7 @@
 #import "CBLStatus.h"
 #import "c4Query.h"
 #import "CBLFleece.hh"
+#import "CBLTrace.hh"
 #import "MRoot.hh"
 
 using namespace fleece;
@@ -93,6 +94,7 @@ namespace cbl {
 }
 
 - (id) nextObject {
+    cbl::TraceSpan span(cbl::TraceEvent::QueryNextRowBegin, cbl::TraceEvent::QueryNextRowEnd);
     __block id row = nil;
     [self.database safeBlock: ^{
         if (_isAllEnumerated)
@@ -107,6 +109,7 @@ namespace cbl {
             CBLLogInfo(Query, @"End of query enumeration (%p)", _c4enum);
         }
     }];
+    span.setResult(row != nil);
     return row;
 }
 
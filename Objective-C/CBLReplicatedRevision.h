@@ -0,0 +1,103 @@
+//
+//  CBLReplicatedRevision.h
+//  CouchbaseLite
+//
+//  Copyright (c) 2022 Couchbase, Inc All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import <Foundation/Foundation.h>
+#import "CBLDocumentFlags.h"
+@class CBLCollection;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A read-only view of a document revision being checked by a replication revision filter.
+ Unlike the CBLDocument given to a CBLReplicationFilter, the properties are read directly from
+ the revision's encoded body without creating a document object, so it's much cheaper when
+ the filter only needs to look at a few properties.
+ 
+ The object is only valid during the call to the filter function, and may be reused for
+ another revision afterwards; do not keep a reference to it or use it on another thread. */
+@interface CBLReplicatedRevision : NSObject
+
+/** The collection the revision belongs to. */
+@property (nonatomic, readonly) CBLCollection* collection;
+
+/** The document ID. */
+@property (nonatomic, readonly) NSString* documentID;
+
+/** The revision ID. */
+@property (nonatomic, readonly) NSString* revisionID;
+
+/** The flags describing the revision. */
+@property (nonatomic, readonly) CBLDocumentFlags flags;
+
+/**
+ Gets a property's value. Dictionaries and arrays are returned as immutable NSDictionary and
+ NSArray objects, and blobs as their metadata dictionaries.
+ Returns nil if the property doesn't exist.
+ 
+ @param key The key.
+ @return The value or nil. */
+- (nullable id) valueForKey: (NSString*)key;
+
+/**
+ Gets a property's value as a string.
+ Returns nil if the property doesn't exist, or its value is not a string.
+ 
+ @param key The key.
+ @return The string value or nil. */
+- (nullable NSString*) stringForKey: (NSString*)key;
+
+/**
+ Gets a property's value as an integer value.
+ Floating point values will be rounded. The value `true` is returned as 1, `false` as 0.
+ Returns 0 if the property doesn't exist or does not have a numeric value.
+ 
+ @param key The key.
+ @return The integer value. */
+- (NSInteger) integerForKey: (NSString*)key;
+
+/**
+ Gets a property's value as a double value.
+ Integers will be converted to double. The value `true` is returned as 1.0, `false` as 0.0.
+ Returns 0.0 if the property doesn't exist or does not have a numeric value.
+ 
+ @param key The key.
+ @return The double value. */
+- (double) doubleForKey: (NSString*)key;
+
+/**
+ Gets a property's value as a boolean.
+ Returns YES if the value exists, and is either `true` or a nonzero number.
+ 
+ @param key The key.
+ @return The boolean value. */
+- (BOOL) booleanForKey: (NSString*)key;
+
+/**
+ Tests whether a property exists or not.
+ 
+ @param key The key.
+ @return True if the property exists, otherwise false. */
+- (BOOL) containsValueForKey: (NSString*)key;
+
+/** Not available */
+- (instancetype) init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,116 @@
+//
+//  CBLReplicatedRevision.mm
+//  CouchbaseLite
+//
+//  Copyright (c) 2022 Couchbase, Inc All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import "CBLReplicatedRevision.h"
+#import "CBLReplicatedRevision+Internal.h"
+#import "CBLCoreBridge.h"
+#import "CBLStringBytes.h"
+
+@implementation CBLReplicatedRevision
+{
+    C4String _docID, _revID;
+    FLDict _body;
+    NSString* _documentID;          // Created on demand from _docID
+    NSString* _revisionID;          // Created on demand from _revID
+}
+
+@synthesize collection=_collection, flags=_flags;
+
+- (instancetype) initWithCollection: (CBLCollection*)collection {
+    self = [super init];
+    if (self) {
+        _collection = collection;
+    }
+    return self;
+}
+
+- (void) setDocID: (C4String)docID
+            revID: (C4String)revID
+            flags: (C4RevisionFlags)flags
+             body: (FLDict)body
+{
+    _docID = docID;
+    _revID = revID;
+    _body = body;
+    
+    _flags = 0;
+    if ((flags & kRevDeleted) == kRevDeleted)
+        _flags |= kCBLDocumentFlagsDeleted;
+    if ((flags & kRevPurged) == kRevPurged)
+        _flags |= kCBLDocumentFlagsAccessRemoved;
+}
+
+- (void) reset {
+    _docID = _revID = kC4SliceNull;
+    _body = nullptr;
+    _flags = 0;
+    _documentID = _revisionID = nil;
+}
+
+- (NSString*) description {
+    return [NSString stringWithFormat: @"%@[%@/%@]", self.class, self.documentID, self.revisionID];
+}
+
+#pragma mark - PROPERTIES:
+
+- (NSString*) documentID {
+    if (!_documentID)
+        _documentID = slice2string(_docID);
+    return _documentID;
+}
+
+- (NSString*) revisionID {
+    if (!_revisionID)
+        _revisionID = slice2string(_revID);
+    return _revisionID;
+}
+
+- (FLValue) fleeceValueForKey: (NSString*)key {
+    CBLStringBytes keySlice(key);
+    return FLDict_Get(_body, keySlice);
+}
+
+- (nullable id) valueForKey: (NSString*)key {
+    return FLValue_GetNSObject([self fleeceValueForKey: key], nullptr);
+}
+
+- (nullable NSString*) stringForKey: (NSString*)key {
+    FLValue value = [self fleeceValueForKey: key];
+    if (FLValue_GetType(value) != kFLString)
+        return nil;
+    return slice2string(FLValue_AsString(value));
+}
+
+- (NSInteger) integerForKey: (NSString*)key {
+    return (NSInteger)FLValue_AsInt([self fleeceValueForKey: key]);
+}
+
+- (double) doubleForKey: (NSString*)key {
+    return FLValue_AsDouble([self fleeceValueForKey: key]);
+}
+
+- (BOOL) booleanForKey: (NSString*)key {
+    return FLValue_AsBool([self fleeceValueForKey: key]);
+}
+
+- (BOOL) containsValueForKey: (NSString*)key {
+    return [self fleeceValueForKey: key] != nullptr;
+}
+
+@end
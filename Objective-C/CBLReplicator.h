@@ -23,8 +23,10 @@
 @class CBLCollection;
 @class CBLDatabase;
 @class CBLDocumentReplication;
+@class CBLDocumentReplicationSummary;
 @class CBLReplicatorChange;
 @class CBLReplicatorConfiguration;
+@class CBLReplicatorMetrics;
 @protocol CBLListenerToken;
 
 NS_ASSUME_NONNULL_BEGIN
@@ -62,6 +64,14 @@ NS_ASSUME_NONNULL_BEGIN
 /** The replicator's current status: its activity level and progress. Observable. */
 @property (readonly, atomic) CBLReplicatorStatus* status;
 
+/** A snapshot of the replicator's throughput and latency metrics. */
+@property (readonly, atomic) CBLReplicatorMetrics* metrics;
+
+/** Whether the metrics count the documents pushed and pulled. Counting them requires the
+    replicator to be notified of every replicated document, so it's off by default. The
+    documents are also counted while document replication listeners are registered. */
+@property (atomic) BOOL documentMetricsEnabled;
+
 /** The SSL/TLS certificate received when connecting to the server. The application code takes responsibility
     for releasing the certificate object when the application code finishes using the certificate. */
 @property (readonly, copy, atomic, nullable) __attribute__((NSObject)) SecCertificateRef serverCertificate;
@@ -143,6 +153,35 @@ the replicator change notification.
 - (id<CBLListenerToken>) addDocumentReplicationListenerWithQueue: (nullable dispatch_queue_t)queue
                                                         listener: (void (^)(CBLDocumentReplication*))listener;
 
+/**
+ Adds a listener for the summaries of the replicated documents: the number of documents
+ replicated in each batch, and the documents that failed. It's much cheaper than a document
+ replication listener when replicating many documents, as no object is created for the
+ documents that replicated successfully. The summaries will be posted on the main queue.
+ 
+ Like the document replication listeners, the listener needs to be added before starting
+ the replicator.
+ 
+ @param listener The listener to post the replication summaries.
+ @return An opaque listener token object for removing the listener.
+ */
+- (id<CBLListenerToken>) addDocumentReplicationSummaryListener: (void (^)(CBLDocumentReplicationSummary*))listener;
+
+/**
+ Adds a listener for the summaries of the replicated documents with the dispatch queue on which
+ the summaries will be posted. If the dispatch queue is not specified, the summaries will be
+ posted on the main queue.
+ 
+ Like the document replication listeners, the listener needs to be added before starting
+ the replicator.
+ 
+ @param queue The dispatch queue.
+ @param listener The listener to post the replication summaries.
+ @return An opaque listener token object for removing the listener.
+ */
+- (id<CBLListenerToken>) addDocumentReplicationSummaryListenerWithQueue: (nullable dispatch_queue_t)queue
+                                                               listener: (void (^)(CBLDocumentReplicationSummary*))listener;
+
 /** 
  Removes a change listener with the given listener token.
  
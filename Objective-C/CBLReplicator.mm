@@ -21,9 +21,11 @@
 #import "CBLCollectionConfiguration+Internal.h"
 #import "CBLCollection+Internal.h"
 #import "CBLDocumentReplication+Internal.h"
+#import "CBLReplicatedRevision+Internal.h"
 #import "CBLReplicator+Internal.h"
 #import "CBLReplicatorChange+Internal.h"
 #import "CBLReplicatorConfiguration.h"
+#import "CBLReplicatorMetrics+Internal.h"
 #import "CBLScope.h"
 #import "CBLURLEndpoint.h"
 #import "fleece/Expert.hh"              // for AllocedDict
@@ -46,12 +48,19 @@
 
 #import "c4Replicator.h"
 #import "c4Socket.h"
+#import "CBLTrace.hh"
 #import "CBLWebSocket.h"
 #import "fleece/Fleece.hh"
 #import <algorithm>
+#import <atomic>
+#import <chrono>
+#import <memory>
+#import <mutex>
+#import <vector>
 
 using namespace std;
 using namespace fleece;
+using namespace cbl;
 
 
 // Replicator progress level types:
@@ -60,6 +69,10 @@ typedef enum {
     kCBLProgressLevelPerDocument,
 } CBLReplicatorProgressLevel;
 
+// Defaults for the conflict resolution pipeline:
+static const NSUInteger kDefaultMaxConflictResolvers = 4;
+static const NSUInteger kDefaultConflictResolutionBatchSize = 50;
+
 // For controlling async start, stop, and suspend:
 typedef enum {
     kCBLStateStopped = 0,       ///< The replicator was stopped.
@@ -71,6 +84,62 @@ typedef enum {
     kCBLStateStarting           ///< The replicator was asked to start but in progress.
 } CBLReplicatorState;
 
+namespace {
+    // Per-collection state precomputed when the C4Replicator is created. Its address is given to
+    // LiteCore as the collection's callback context, so the push/pull filter callbacks get to the
+    // collection and its filters directly, without any lookup or string conversion.
+    struct ReplicatorCollection {
+        __unsafe_unretained CBLReplicator* replicator;
+        C4CollectionSpec spec;          // Points to the slices below
+        alloc_slice scopeName, name;
+        CBLCollection* collection;
+        CBLCollectionConfiguration* config;
+        CBLReplicationFilter pushFilter, pullFilter;
+        CBLReplicationRevisionFilter pushRevisionFilter, pullRevisionFilter;
+        
+        ReplicatorCollection(CBLReplicator* repl, CBLCollection* col,
+                             CBLCollectionConfiguration* colConfig)
+        :replicator(repl)
+        ,scopeName(slice(CBLStringBytes(col.scope.name)))
+        ,name(slice(CBLStringBytes(col.name)))
+        ,collection(col)
+        ,config(colConfig)
+        ,pushFilter(colConfig.pushFilter)
+        ,pullFilter(colConfig.pullFilter)
+        ,pushRevisionFilter(colConfig.pushRevisionFilter)
+        ,pullRevisionFilter(colConfig.pullRevisionFilter)
+        {
+            spec = {name, scopeName};
+        }
+        
+        // Filters may be called concurrently on LiteCore threads, so the revision views passed
+        // to revision filters are recycled through a small pool instead of being shared.
+        CBLReplicatedRevision* acquireRevision() {
+            {
+                lock_guard<mutex> lock(_poolMutex);
+                if (!_revisionPool.empty()) {
+                    CBLReplicatedRevision* rev = _revisionPool.back();
+                    _revisionPool.pop_back();
+                    return rev;
+                }
+            }
+            return [[CBLReplicatedRevision alloc] initWithCollection: collection];
+        }
+        
+        void releaseRevision(CBLReplicatedRevision* rev) {
+            [rev reset];
+            lock_guard<mutex> lock(_poolMutex);
+            if (_revisionPool.size() < kMaxPooledRevisions)
+                _revisionPool.push_back(rev);
+        }
+        
+    private:
+        static constexpr size_t kMaxPooledRevisions = 8;
+        mutex _poolMutex;
+        vector<CBLReplicatedRevision*> _revisionPool;
+    };
+}
+
 @interface CBLReplicator () <CBLLockable, CBLRemovableListenerToken>
 @property (readwrite, atomic) CBLReplicatorStatus* status;
 @end
@@ -88,11 +157,21 @@ typedef enum {
     CBLReplicatorProgressLevel _progressLevel;
     CBLChangeNotifier<CBLReplicatorChange*>* _changeNotifier;
     CBLChangeNotifier<CBLDocumentReplication*>* _docReplicationNotifier;
+    CBLChangeNotifier<CBLDocumentReplicationSummary*>* _docSummaryNotifier;
+    atomic<bool> _hasDocReplicationListeners;   // Read by onDocsEnded on LiteCore's thread
+    atomic<bool> _hasDocSummaryListeners;       // Read by onDocsEnded on LiteCore's thread
     BOOL _resetCheckpoint;          // Reset the replicator checkpoint
     unsigned _conflictCount;        // Current number of conflict resolving tasks
+    NSMutableArray<CBLReplicatedDocument*>* _pendingConflicts; // Conflicts waiting for a worker
+    unsigned _conflictWorkers;      // Number of running conflict resolver workers
+    CBLConflictResolutionStats _conflictStats;
+    ReplicatorCounters _counters;   // Shared with the CBLWebSocket
+    NSTimeInterval _activeTime;     // Total running time, excluding the current run
+    CFAbsoluteTime _activeSince;    // When the current run started, or 0 if not running
+    BOOL _documentMetricsEnabled;   // Count the replicated documents for the metrics
     BOOL _deferReplicatorNotification; // Defer replicator notification until finishing all conflict resolving tasks
     SecCertificateRef _serverCertificate;
-    NSDictionary* _collectionMap;   // [scopeName.collectionName : CBLCollection]
+    vector<unique_ptr<ReplicatorCollection>> _collections; // Callback contexts of the _repl
 }
 
 @synthesize config=_config;
@@ -120,6 +199,7 @@ typedef enum {
         _progressLevel = kCBLProgressLevelOverall;
         _changeNotifier = [CBLChangeNotifier new];
         _docReplicationNotifier = [CBLChangeNotifier new];
+        _docSummaryNotifier = [CBLChangeNotifier new];
         _status = [[CBLReplicatorStatus alloc] initWithStatus: {kC4Stopped, {}, {}}];
         
         NSString* qName = self.description;
@@ -127,6 +207,7 @@ typedef enum {
         
         NSString* cqName = $sprintf(@"%@ : Conflicts", qName);
         _conflictQueue = dispatch_queue_create(cqName.UTF8String, DISPATCH_QUEUE_CONCURRENT);
+        _pendingConflicts = [NSMutableArray array];
     }
     return self;
 }
@@ -264,17 +345,22 @@ typedef enum {
     C4ReplicationCollection cols[collectionCount];
     alloc_slice optionDicts[collectionCount];
     NSUInteger i = 0;
+    _collections.clear();
+    _collections.reserve(collectionCount);
     for (CBLCollection* col in _config.collectionConfigs) {
         CBLCollectionConfiguration* colConfig = _config.collectionConfigs[col];
         alloc_slice dict = [self encodedOptions: colConfig.effectiveOptions];
         
+        _collections.emplace_back(new ReplicatorCollection(self, col, colConfig));
+        ReplicatorCollection* rc = _collections.back().get();
+        
         C4ReplicationCollection c = {
-            .collection = col.c4spec,
+            .collection = rc->spec,
             .push = mkmode(isPush(_config.replicatorType), _config.continuous),
             .pull = mkmode(isPull(_config.replicatorType), _config.continuous),
-            .pushFilter = filter(colConfig.pushFilter, true),
-            .pullFilter = filter(colConfig.pullFilter, false),
-            .callbackContext    = (__bridge void*)self,
+            .pushFilter = filter(rc->pushFilter, rc->pushRevisionFilter, true),
+            .pullFilter = filter(rc->pullFilter, rc->pullRevisionFilter, false),
+            .callbackContext    = rc,
             .optionsDictFleece  = dict,
         };
         optionDicts[i] = dict;
@@ -285,8 +371,6 @@ typedef enum {
     
     [self initReachability: _reachabilityURL];
     
-    [self createCollectionMap];
-
     // Create a C4Replicator:
     [_config.database safeBlock: ^{
         [_config.database mustBeOpenLocked];
@@ -318,15 +402,6 @@ typedef enum {
     return enc.finish();
 }
 
-- (void) createCollectionMap {
-    NSArray* collections = _config.collections;
-    NSMutableDictionary* mdict = [NSMutableDictionary dictionaryWithCapacity: collections.count];
-    for (CBLCollection* col in collections)
-        [mdict setObject: col forKey: $sprintf(@"%@.%@", col.scope.name, col.name)];
-    
-    _collectionMap = [NSDictionary dictionaryWithDictionary: mdict];
-}
-
 static C4ReplicatorMode mkmode(BOOL active, BOOL continuous) {
     C4ReplicatorMode const kModes[4] = {kC4Disabled, kC4Disabled, kC4OneShot, kC4Continuous};
     return kModes[2*!!active + !!continuous];
@@ -340,8 +415,22 @@ static BOOL isPull(CBLReplicatorType type) {
     return type == kCBLReplicatorTypePushAndPull || type == kCBLReplicatorTypePull;
 }
 
-static C4ReplicatorValidationFunction filter(CBLReplicationFilter filter, bool isPush) {
-    return filter != nil ? (isPush ? &pushFilter : &pullFilter) : NULL;
+static C4ReplicatorValidationFunction filter(CBLReplicationFilter filter,
+                                             CBLReplicationRevisionFilter revisionFilter,
+                                             bool isPush) {
+    if (filter == nil && revisionFilter == nil)
+        return NULL;
+    return isPush ? &pushFilter : &pullFilter;
+}
+
+// Returns the collection state matching the spec, or NULL. The collection count is small, so
+// a linear scan comparing slices is cheaper than building and hashing a key.
+- (ReplicatorCollection*) replicatorCollection: (C4CollectionSpec)spec {
+    for (auto& rc : _collections) {
+        if (FLSlice_Equal(rc->spec.name, spec.name) && FLSlice_Equal(rc->spec.scope, spec.scope))
+            return rc.get();
+    }
+    return nullptr;
 }
 
 - (void) stop {
@@ -424,17 +513,33 @@ static C4ReplicatorValidationFunction filter(CBLReplicationFilter filter, bool i
                                                         listener: (void (^)(CBLDocumentReplication*))listener
 {
     CBL_LOCK(self) {
-        [self setProgressLevel: kCBLProgressLevelPerDocument];
+        _hasDocReplicationListeners = true;
+        [self updateProgressLevel];
         return [_docReplicationNotifier addChangeListenerWithQueue: queue listener: listener delegate: nil];
     }
 }
 
+- (id<CBLListenerToken>) addDocumentReplicationSummaryListener: (void (^)(CBLDocumentReplicationSummary*))listener {
+    return [self addDocumentReplicationSummaryListenerWithQueue: nil listener: listener];
+}
+
+- (id<CBLListenerToken>) addDocumentReplicationSummaryListenerWithQueue: (nullable dispatch_queue_t)queue
+                                                               listener: (void (^)(CBLDocumentReplicationSummary*))listener
+{
+    CBL_LOCK(self) {
+        _hasDocSummaryListeners = true;
+        [self updateProgressLevel];
+        return [_docSummaryNotifier addChangeListenerWithQueue: queue listener: listener delegate: nil];
+    }
+}
+
 - (void) removeChangeListenerWithToken: (id<CBLListenerToken>)token {
     [_changeNotifier removeChangeListenerWithToken: token];
     
     CBL_LOCK(self) {
-        if ([_docReplicationNotifier removeChangeListenerWithToken: token] == 0)
-            [self setProgressLevel: kCBLProgressLevelOverall];
+        _hasDocReplicationListeners = [_docReplicationNotifier removeChangeListenerWithToken: token] > 0;
+        _hasDocSummaryListeners = [_docSummaryNotifier removeChangeListenerWithToken: token] > 0;
+        [self updateProgressLevel];
     }
 }
 
@@ -444,6 +549,16 @@ static C4ReplicatorValidationFunction filter(CBLReplicationFilter filter, bool i
     [self removeChangeListenerWithToken: token];
 }
 
+// LiteCore only reports each replicated document when something needs them: document
+// replication listeners, or the document counts of the metrics. Must be called under the lock.
+- (void) updateProgressLevel {
+    bool perDocument = _documentMetricsEnabled || _hasDocReplicationListeners || _hasDocSummaryListeners;
+    CBLReplicatorProgressLevel level = perDocument ? kCBLProgressLevelPerDocument
+                                                   : kCBLProgressLevelOverall;
+    if (level != _progressLevel)
+        [self setProgressLevel: level];
+}
+
 - (void) setProgressLevel: (CBLReplicatorProgressLevel)level {
     _progressLevel = level;
     if (_repl) {
@@ -602,6 +717,16 @@ static void statusChanged(C4Replicator *repl, C4ReplicatorStatus status, void *c
         
         // Record raw status:
         _rawStatus = c4Status;
+        trace(TraceEvent::ReplicatorStatus, c4Status.level, c4Status.error.code);
+        
+        // Track the running time for the metrics:
+        bool running = c4Status.level > kC4Offline;
+        if (running && _activeSince == 0) {
+            _activeSince = CFAbsoluteTimeGetCurrent();
+        } else if (!running && _activeSince != 0) {
+            _activeTime += CFAbsoluteTimeGetCurrent() - _activeSince;
+            _activeSince = 0;
+        }
         
         // Running; idle or busy:
         if (c4Status.level > kC4Connecting) {
@@ -682,15 +807,63 @@ static void onDocsEnded(C4Replicator* repl,
 {
     auto replicator = (__bridge CBLReplicator*)context;
     
-    NSMutableArray* docs = [NSMutableArray new];
+    // Without document replication listeners, only the conflicts need to be bridged, to be
+    // resolved; the other documents are just logged and counted for the summary listeners:
+    bool allDocs = replicator->_hasDocReplicationListeners;
+    bool summary = !allDocs && replicator->_hasDocSummaryListeners;
+    NSMutableArray* docs = nil;
+    NSMutableArray* failedDocs = nil;
+    NSUInteger summaryCount = 0;
+    uint64_t nErrors = 0;
     for (size_t i = 0; i < nDocs; ++i) {
-        [docs addObject: [[CBLReplicatedDocument alloc] initWithC4DocumentEnded: docEnds[i]]];
+        const C4DocumentEnded* docEnd = docEnds[i];
+        const C4Error& c4err = docEnd->error;
+        bool conflict = !pushing && c4err.domain == LiteCoreDomain && c4err.code == kC4ErrorConflict;
+        if (c4err.code && !conflict)
+            ++nErrors;
+        if (allDocs || conflict) {
+            if (!docs)
+                docs = [NSMutableArray new];
+            [docs addObject: [[CBLReplicatedDocument alloc] initWithC4DocumentEnded: docEnd]];
+            continue;
+        }
+        
+        if (c4err.code) {
+            CBLLogInfo(Sync, @"%@: %serror %s '%.*s': %d/%d", replicator,
+                       (docEnd->errorIsTransient ? "transient " : ""),
+                       (pushing ? "pushing" : "pulling"),
+                       (int)docEnd->docID.size, (const char*)docEnd->docID.buf,
+                       c4err.domain, c4err.code);
+            if (summary) {
+                if (!failedDocs)
+                    failedDocs = [NSMutableArray new];
+                [failedDocs addObject: [[CBLReplicatedDocument alloc] initWithC4DocumentEnded: docEnd]];
+            }
+        }
+        summaryCount++;
+    }
+    
+    // LiteCore still reports conflicts and errors at the overall progress level; count documents
+    // only with per-document progress, so the metrics read zero while it's off:
+    if (replicator->_progressLevel == kCBLProgressLevelPerDocument) {
+        ReplicatorCounters& counters = replicator->_counters;
+        (pushing ? counters.docsPushed : counters.docsPulled).fetch_add(nDocs - nErrors,
+                                                                        memory_order_relaxed);
+        counters.docErrors.fetch_add(nErrors, memory_order_relaxed);
     }
-   
+    
+    if (!docs && !(summary && summaryCount > 0))
+        return;
+    
     dispatch_async(replicator->_dispatchQueue, ^{
         [replicator safeBlock:^{
             if (repl == replicator->_repl) {
-                [replicator onDocsEnded: docs pushing: pushing];
+                if (docs)
+                    [replicator onDocsEnded: docs pushing: pushing];
+                if (summary && summaryCount > 0)
+                    [replicator postDocumentReplicationSummary: summaryCount
+                                               failedDocuments: failedDocs ?: @[]
+                                                       pushing: pushing];
             }
         }];
     });
@@ -711,50 +884,181 @@ static void onDocsEnded(C4Replicator* repl,
         [self postDocumentReplications: posts pushing: pushing];
 }
 
+// Queues a conflict for the resolver workers, starting another worker if the pending conflicts
+// are more than the running workers will take in their next batches. Called under the lock.
 - (void) resolveConflict: (CBLReplicatedDocument*)doc {
     _conflictCount++;
-    dispatch_async(_conflictQueue, ^{
-        [self _resolveConflict: doc];
+    [_pendingConflicts addObject: doc];
+    
+    NSUInteger maxWorkers = _config.maxConflictResolvers ?: kDefaultMaxConflictResolvers;
+    NSUInteger batchSize = _config.conflictResolutionBatchSize ?: kDefaultConflictResolutionBatchSize;
+    if (_conflictWorkers < maxWorkers && _pendingConflicts.count > _conflictWorkers * batchSize) {
+        _conflictWorkers++;
+        dispatch_async(_conflictQueue, ^{
+            [self runConflictResolver];
+        });
+    }
+}
+
+// Runs on the _conflictQueue, resolving batches of pending conflicts until there are none left.
+- (void) runConflictResolver {
+    NSUInteger batchSize = _config.conflictResolutionBatchSize ?: kDefaultConflictResolutionBatchSize;
+    while (true) {
+        NSArray<CBLReplicatedDocument*>* batch;
         CBL_LOCK(self) {
-            if (--_conflictCount == 0 && _deferReplicatorNotification) {
-                if (_rawStatus.level == kC4Stopped) {
-                    Assert(_state == kCBLStateStopping);
-                    [self stopped];
-                }
+            NSRange range = NSMakeRange(0, MIN(batchSize, _pendingConflicts.count));
+            if (range.length == 0) {
+                _conflictWorkers--;
+                return;
+            }
+            batch = [_pendingConflicts subarrayWithRange: range];
+            [_pendingConflicts removeObjectsInRange: range];
+        }
+        
+        CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+        NSUInteger failed;
+        @autoreleasepool {
+            failed = [self resolveConflicts: batch];
+        }
+        NSTimeInterval elapsed = CFAbsoluteTimeGetCurrent() - start;
+        
+        CBL_LOCK(self) {
+            _conflictStats.resolved += batch.count - failed;
+            _conflictStats.failed += failed;
+            _conflictStats.batches++;
+            _conflictStats.time += elapsed;
+            
+            _conflictCount -= (unsigned)batch.count;
+            if (_conflictCount == 0) {
+                CBLLogInfo(Sync, @"%@: Resolved %llu conflicts (%llu failed) in %llu batches, "
+                           "%.0f docs/sec per worker", self, _conflictStats.resolved,
+                           _conflictStats.failed, _conflictStats.batches,
+                           (_conflictStats.resolved + _conflictStats.failed) / MAX(_conflictStats.time, 1e-6));
                 
-                _deferReplicatorNotification = NO;
-                [self updateAndPostStatus];
+                if (_deferReplicatorNotification) {
+                    if (_rawStatus.level == kC4Stopped) {
+                        Assert(_state == kCBLStateStopping);
+                        [self stopped];
+                    }
+                    
+                    _deferReplicatorNotification = NO;
+                    [self updateAndPostStatus];
+                }
             }
         }
-    });
+    }
 }
 
-- (void) _resolveConflict: (CBLReplicatedDocument*)doc {
-    CBLLogInfo(Sync, @"%@: Resolve conflicting version of '%@'", self, doc.id);
-    
-    CBLCollection* c = [_collectionMap objectForKey: $sprintf(@"%@.%@", doc.scope, doc.collection)];
-    Assert(c, kCBLErrorMessageCollectionNotFoundDuringConflict);
-    
-    CBLCollectionConfiguration* colConfig = [_config collectionConfig: c];
-    Assert(colConfig, kCBLErrorMessageConfigNotFoundDuringConflict);
+// Resolves a batch of conflicts, grouped by collection so that each group is read and saved by
+// its collection in one go. Returns the number of conflicts that failed to be resolved.
+- (NSUInteger) resolveConflicts: (NSArray<CBLReplicatedDocument*>*)docs {
+    NSUInteger count = docs.count;
+    vector<ReplicatorCollection*> docCollections(count);
+    for (NSUInteger i = 0; i < count; i++) {
+        CBLReplicatedDocument* doc = docs[i];
+        CBLStringBytes scopeName(doc.scope), name(doc.collection);
+        C4CollectionSpec spec = {.name = name, .scope = scopeName};
+        docCollections[i] = [self replicatorCollection: spec];
+        Assert(docCollections[i], kCBLErrorMessageCollectionNotFoundDuringConflict);
+    }
     
-    NSError* error = nil;
-    if (![c resolveConflictInDocument: doc.id
-                 withConflictResolver: colConfig.conflictResolver
-                                error: &error]) {
-        CBLWarn(Sync, @"%@: Conflict resolution of '%@' failed: %@", self, doc.id, error);
+    NSUInteger failed = 0;
+    for (auto& entry : _collections) {
+        ReplicatorCollection* rc = entry.get();
+        NSMutableArray<CBLReplicatedDocument*>* group = [NSMutableArray array];
+        NSMutableArray<NSString*>* docIDs = [NSMutableArray array];
+        for (NSUInteger i = 0; i < count; i++) {
+            if (docCollections[i] == rc) {
+                [group addObject: docs[i]];
+                [docIDs addObject: docs[i].id];
+            }
+        }
+        if (group.count == 0)
+            continue;
+        
+        CBLLogInfo(Sync, @"%@: Resolve %lu conflicting documents in %@",
+                   self, (unsigned long)group.count, rc->collection);
+        NSArray* errors = [rc->collection resolveConflictsInDocuments: docIDs
+                                                 withConflictResolver: rc->config.conflictResolver];
+        for (NSUInteger i = 0; i < group.count; i++) {
+            CBLReplicatedDocument* doc = group[i];
+            NSError* error = $castIf(NSError, errors[i]);
+            if (error) {
+                CBLWarn(Sync, @"%@: Conflict resolution of '%@' failed: %@", self, doc.id, error);
+                failed++;
+            }
+            [doc updateError: error];
+            [self logErrorOnDocument: doc pushing: NO];
+        }
     }
     
-    [doc updateError: error];
-    [self logErrorOnDocument: doc pushing: NO];
-    [self postDocumentReplications: @[doc] pushing: NO];
+    [self postDocumentReplications: docs pushing: NO];
+    return failed;
+}
+
+- (ReplicatorCounters*) counters {
+    return &_counters;
+}
+
+- (BOOL) documentMetricsEnabled {
+    CBL_LOCK(self) {
+        return _documentMetricsEnabled;
+    }
+}
+
+- (void) setDocumentMetricsEnabled: (BOOL)enabled {
+    CBL_LOCK(self) {
+        _documentMetricsEnabled = enabled;
+        [self updateProgressLevel];
+    }
+}
+
+- (CBLReplicatorMetrics*) metrics {
+    CBL_LOCK(self) {
+        NSTimeInterval activeTime = _activeTime;
+        if (_activeSince != 0)
+            activeTime += CFAbsoluteTimeGetCurrent() - _activeSince;
+        return [[CBLReplicatorMetrics alloc] initWithCounters: _counters
+                                                   activeTime: activeTime
+                                            conflictsResolved: _conflictStats.resolved
+                                              conflictsFailed: _conflictStats.failed
+                                       conflictResolutionTime: _conflictStats.time];
+    }
+}
+
+- (CBLConflictResolutionStats) conflictResolutionStats {
+    CBL_LOCK(self) {
+        return _conflictStats;
+    }
 }
 
 - (void) postDocumentReplications: (NSArray<CBLReplicatedDocument*>*)docs pushing: (BOOL)pushing {
-    id replication = [[CBLDocumentReplication alloc] initWithReplicator: self
-                                                                 isPush: pushing
-                                                              documents: docs];
-    [_docReplicationNotifier postChange: replication];
+    if (_hasDocReplicationListeners) {
+        id replication = [[CBLDocumentReplication alloc] initWithReplicator: self
+                                                                     isPush: pushing
+                                                                  documents: docs];
+        [_docReplicationNotifier postChange: replication];
+    }
+    
+    if (_hasDocSummaryListeners) {
+        NSMutableArray* failedDocs = [NSMutableArray array];
+        for (CBLReplicatedDocument* doc in docs) {
+            if (doc.error)
+                [failedDocs addObject: doc];
+        }
+        [self postDocumentReplicationSummary: docs.count failedDocuments: failedDocs pushing: pushing];
+    }
+}
+
+- (void) postDocumentReplicationSummary: (NSUInteger)count
+                        failedDocuments: (NSArray<CBLReplicatedDocument*>*)failedDocs
+                                pushing: (BOOL)pushing
+{
+    id summary = [[CBLDocumentReplicationSummary alloc] initWithReplicator: self
+                                                                    isPush: pushing
+                                                             documentCount: count
+                                                           failedDocuments: failedDocs];
+    [_docSummaryNotifier postChange: summary];
 }
 
 - (void) logErrorOnDocument: (CBLReplicatedDocument*)doc pushing: (BOOL)pushing {
@@ -769,32 +1073,52 @@ static void onDocsEnded(C4Replicator* repl,
 static bool pushFilter(C4CollectionSpec collectionSpec,
                        C4String docID, C4String revID, C4RevisionFlags flags,
                        FLDict flbody, void *context) {
-    auto replicator = (__bridge CBLReplicator*)context;
-    return [replicator filterDocument: collectionSpec docID: docID revID: revID
-                                flags: flags body: flbody pushing: true];
+    return timedFilter((ReplicatorCollection*)context, docID, revID, flags, flbody, true);
 }
 
 static bool pullFilter(C4CollectionSpec collectionSpec,
                        C4String docID, C4String revID, C4RevisionFlags flags,
                        FLDict flbody, void *context) {
-    auto replicator = (__bridge CBLReplicator*)context;
-    return [replicator filterDocument: collectionSpec docID: docID revID: revID
-                                flags: flags body: flbody pushing: false];
+    return timedFilter((ReplicatorCollection*)context, docID, revID, flags, flbody, false);
+}
+
+static bool timedFilter(ReplicatorCollection* rc,
+                        C4String docID, C4String revID, C4RevisionFlags flags,
+                        FLDict flbody, bool pushing) {
+    auto start = chrono::steady_clock::now();
+    bool result = [rc->replicator filterDocument: rc docID: docID revID: revID
+                                           flags: flags body: flbody pushing: pushing];
+    auto elapsed = chrono::steady_clock::now() - start;
+    ReplicatorCounters& counters = rc->replicator->_counters;
+    counters.filterCalls.fetch_add(1, memory_order_relaxed);
+    counters.filterNanos.fetch_add(chrono::duration_cast<chrono::nanoseconds>(elapsed).count(),
+                                   memory_order_relaxed);
+    return result;
 }
 
-- (bool) filterDocument: (C4CollectionSpec)c4spec
+- (bool) filterDocument: (ReplicatorCollection*)rc
                   docID: (C4String)docID
                   revID: (C4String)revID
                   flags: (C4RevisionFlags)flags
                    body: (FLDict)body
                 pushing: (bool)pushing
 {
-    NSString* name = slice2string(c4spec.name);
-    NSString* scopeName = slice2string(c4spec.scope);
-    CBLCollection* c = [_collectionMap objectForKey: $sprintf(@"%@.%@", scopeName, name)];
-    Assert(c, kCBLErrorMessageCollectionNotFoundInFilter);
+    CBLReplicationRevisionFilter revisionFilter = pushing ? rc->pushRevisionFilter
+                                                          : rc->pullRevisionFilter;
+    if (revisionFilter) {
+        CBLReplicatedRevision* rev = rc->acquireRevision();
+        [rev setDocID: docID revID: revID flags: flags body: body];
+        BOOL accepted = revisionFilter(rev);
+        rc->releaseRevision(rev);
+        if (!accepted)
+            return false;
+    }
+    
+    CBLReplicationFilter filter = pushing ? rc->pushFilter : rc->pullFilter;
+    if (!filter)
+        return true;
     
-    auto doc = [[CBLDocument alloc] initWithCollection: c
+    auto doc = [[CBLDocument alloc] initWithCollection: rc->collection
                                             documentID: slice2string(docID)
                                             revisionID: slice2string(revID)
                                                   body: body];
@@ -805,10 +1129,7 @@ static bool pullFilter(C4CollectionSpec collectionSpec,
     if ((flags & kRevPurged) == kRevPurged)
         docFlags |= kCBLDocumentFlagsAccessRemoved;
     
-    CBLCollectionConfiguration* colConfig = [_config collectionConfig: c];
-    Assert(colConfig, @"Collection config is not found in the replicator config when " \
-           "calling the filter function.");
-    return pushing ? colConfig.pushFilter(doc, docFlags) : colConfig.pullFilter(doc, docFlags);
+    return filter(doc, docFlags);
 }
 
 #pragma mark - BACKGROUNDING SUPPORT:
@@ -176,6 +176,28 @@ __deprecated_msg(" Use [... initWithTarget:] and [config addCollection: config:]
  */
 @property (nonatomic) BOOL enableAutoPurge;
 
+/**
+ Compresses the WebSocket messages with the permessage-deflate extension (RFC 7692), if the
+ server accepts it. This reduces the bytes sent over the network, which helps on slow or metered
+ connections, at the cost of some CPU time. The default value is NO.
+ */
+@property (nonatomic) BOOL webSocketCompression;
+
+/**
+ The size of the LZ77 window, as a power of two from 9 to 15, used to compress outgoing messages
+ when webSocketCompression is enabled. Larger windows compress better but use more memory per
+ connection. Values outside the range are clamped to it. Set the value to zero (by default) to use
+ the default of 15.
+ */
+@property (nonatomic) NSUInteger webSocketCompressionWindowBits;
+
+/**
+ The size in bytes below which outgoing messages are sent uncompressed when webSocketCompression
+ is enabled, since compressing small messages costs more than it saves. Set the value to zero
+ (by default) to use the default of 256 bytes.
+ */
+@property (nonatomic) NSUInteger webSocketCompressionThreshold;
+
 /** The collections used for the replication. */
 @property (nonatomic, readonly) NSArray<CBLCollection*>* collections;
 
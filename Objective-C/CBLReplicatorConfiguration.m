@@ -43,6 +43,11 @@
 @synthesize headers=_headers;
 @synthesize networkInterface=_networkInterface;
 @synthesize checkpointInterval=_checkpointInterval, heartbeat=_heartbeat;
+@synthesize webSocketCompression=_webSocketCompression;
+@synthesize webSocketCompressionWindowBits=_webSocketCompressionWindowBits;
+@synthesize webSocketCompressionThreshold=_webSocketCompressionThreshold;
+@synthesize maxConflictResolvers=_maxConflictResolvers;
+@synthesize conflictResolutionBatchSize=_conflictResolutionBatchSize;
 @synthesize maxAttempts=_maxAttempts, maxAttemptWaitTime=_maxAttemptWaitTime;
 @synthesize enableAutoPurge=_enableAutoPurge;
 @synthesize collectionConfigs=_collectionConfigs;
@@ -237,6 +242,21 @@
     _maxAttemptWaitTime = maxAttemptWaitTime;
 }
 
+- (void) setWebSocketCompression: (BOOL)webSocketCompression {
+    [self checkReadonly];
+    _webSocketCompression = webSocketCompression;
+}
+
+- (void) setWebSocketCompressionWindowBits: (NSUInteger)webSocketCompressionWindowBits {
+    [self checkReadonly];
+    _webSocketCompressionWindowBits = webSocketCompressionWindowBits;
+}
+
+- (void) setWebSocketCompressionThreshold: (NSUInteger)webSocketCompressionThreshold {
+    [self checkReadonly];
+    _webSocketCompressionThreshold = webSocketCompressionThreshold;
+}
+
 - (void) setEnableAutoPurge: (BOOL)enableAutoPurge {
     [self checkReadonly];
     _enableAutoPurge = enableAutoPurge;
@@ -332,6 +352,11 @@
         }
         _heartbeat = config.heartbeat;
         _checkpointInterval = config.checkpointInterval;
+        _webSocketCompression = config.webSocketCompression;
+        _webSocketCompressionWindowBits = config.webSocketCompressionWindowBits;
+        _webSocketCompressionThreshold = config.webSocketCompressionThreshold;
+        _maxConflictResolvers = config.maxConflictResolvers;
+        _conflictResolutionBatchSize = config.conflictResolutionBatchSize;
         _maxAttempts = config.maxAttempts;
         _maxAttemptWaitTime = config.maxAttemptWaitTime;
         _enableAutoPurge = config.enableAutoPurge;
@@ -385,6 +410,15 @@
     if (_heartbeat > 0)
         options[@kC4ReplicatorHeartbeatInterval] = @(_heartbeat);
     
+    // WebSocket compression (no public api now):
+    if (_webSocketCompression) {
+        options[@kCBLReplicatorOptionWSCompression] = @YES;
+        if (_webSocketCompressionWindowBits > 0)
+            options[@kCBLReplicatorOptionWSCompressionWindowBits] = @(_webSocketCompressionWindowBits);
+        if (_webSocketCompressionThreshold > 0)
+            options[@kCBLReplicatorOptionWSCompressionThreshold] = @(_webSocketCompressionThreshold);
+    }
+    
     if (_maxAttemptWaitTime > 0)
         options[@kC4ReplicatorOptionMaxRetryInterval] = @(_maxAttemptWaitTime);
     
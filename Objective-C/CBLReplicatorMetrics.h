@@ -0,0 +1,89 @@
+//
+//  CBLReplicatorMetrics.h
+//  CouchbaseLite
+//
+//  Copyright (c) 2022 Couchbase, Inc All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A snapshot of a replicator's throughput and latency metrics, accumulated since the replicator
+ was created. The metrics are always collected, except for the document counts and the rates
+ derived from them, which are only collected while CBLReplicator.documentMetricsEnabled is set
+ or document replication listeners are registered. Getting a snapshot is cheap. */
+@interface CBLReplicatorMetrics : NSObject
+
+/** The total time the replicator has been running (connecting, busy or idle), in seconds. */
+@property (nonatomic, readonly) NSTimeInterval activeTime;
+
+/** The number of documents pushed successfully. */
+@property (nonatomic, readonly) uint64_t documentsPushed;
+
+/** The number of documents pulled successfully, including the ones that were in conflict. */
+@property (nonatomic, readonly) uint64_t documentsPulled;
+
+/** The number of documents that failed to replicate. */
+@property (nonatomic, readonly) uint64_t documentErrors;
+
+/** The average number of documents pushed per second of active time. */
+@property (nonatomic, readonly) double pushRate;
+
+/** The average number of documents pulled per second of active time. */
+@property (nonatomic, readonly) double pullRate;
+
+/** The number of bytes sent over the network, including WebSocket framing and TLS. */
+@property (nonatomic, readonly) uint64_t bytesSent;
+
+/** The number of bytes received from the network, including WebSocket framing and TLS. */
+@property (nonatomic, readonly) uint64_t bytesReceived;
+
+/** The number of WebSocket messages sent. */
+@property (nonatomic, readonly) uint64_t messagesSent;
+
+/** The number of WebSocket messages received. */
+@property (nonatomic, readonly) uint64_t messagesReceived;
+
+/** The average number of documents replicated per WebSocket message sent or received. */
+@property (nonatomic, readonly) double revisionsPerMessage;
+
+/** The round-trip time of the latest connection's WebSocket handshake, in seconds, or 0 if
+    the replicator hasn't connected to a remote URL endpoint. */
+@property (nonatomic, readonly) NSTimeInterval roundTripTime;
+
+/** The number of conflicts resolved. */
+@property (nonatomic, readonly) uint64_t conflictsResolved;
+
+/** The number of conflicts that failed to be resolved. */
+@property (nonatomic, readonly) uint64_t conflictsFailed;
+
+/** The total time spent resolving conflicts, including calling the conflict resolvers and
+    saving the resolved documents, in seconds. */
+@property (nonatomic, readonly) NSTimeInterval conflictResolutionTime;
+
+/** The number of calls to the push and pull filters. */
+@property (nonatomic, readonly) uint64_t filterCalls;
+
+/** The total time spent in the push and pull filters, in seconds. */
+@property (nonatomic, readonly) NSTimeInterval filterTime;
+
+/** Not available */
+- (instancetype) init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,85 @@
+//
+//  CBLReplicatorMetrics.mm
+//  CouchbaseLite
+//
+//  Copyright (c) 2022 Couchbase, Inc All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import "CBLReplicatorMetrics.h"
+#import "CBLReplicatorMetrics+Internal.h"
+
+using namespace cbl;
+
+@implementation CBLReplicatorMetrics
+
+@synthesize activeTime=_activeTime;
+@synthesize documentsPushed=_documentsPushed, documentsPulled=_documentsPulled;
+@synthesize documentErrors=_documentErrors;
+@synthesize bytesSent=_bytesSent, bytesReceived=_bytesReceived;
+@synthesize messagesSent=_messagesSent, messagesReceived=_messagesReceived;
+@synthesize roundTripTime=_roundTripTime;
+@synthesize conflictsResolved=_conflictsResolved, conflictsFailed=_conflictsFailed;
+@synthesize conflictResolutionTime=_conflictResolutionTime;
+@synthesize filterCalls=_filterCalls, filterTime=_filterTime;
+
+- (instancetype) initWithCounters: (const ReplicatorCounters&)counters
+                       activeTime: (NSTimeInterval)activeTime
+                conflictsResolved: (uint64_t)conflictsResolved
+                  conflictsFailed: (uint64_t)conflictsFailed
+           conflictResolutionTime: (NSTimeInterval)conflictResolutionTime
+{
+    self = [super init];
+    if (self) {
+        _activeTime = activeTime;
+        _documentsPushed = counters.docsPushed.load(std::memory_order_relaxed);
+        _documentsPulled = counters.docsPulled.load(std::memory_order_relaxed);
+        _documentErrors = counters.docErrors.load(std::memory_order_relaxed);
+        _bytesSent = counters.bytesSent.load(std::memory_order_relaxed);
+        _bytesReceived = counters.bytesReceived.load(std::memory_order_relaxed);
+        _messagesSent = counters.messagesSent.load(std::memory_order_relaxed);
+        _messagesReceived = counters.messagesReceived.load(std::memory_order_relaxed);
+        _roundTripTime = counters.roundTripNanos.load(std::memory_order_relaxed) / 1.0e9;
+        _conflictsResolved = conflictsResolved;
+        _conflictsFailed = conflictsFailed;
+        _conflictResolutionTime = conflictResolutionTime;
+        _filterCalls = counters.filterCalls.load(std::memory_order_relaxed);
+        _filterTime = counters.filterNanos.load(std::memory_order_relaxed) / 1.0e9;
+    }
+    return self;
+}
+
+- (double) pushRate {
+    return _activeTime > 0 ? _documentsPushed / _activeTime : 0.0;
+}
+
+- (double) pullRate {
+    return _activeTime > 0 ? _documentsPulled / _activeTime : 0.0;
+}
+
+- (double) revisionsPerMessage {
+    uint64_t messages = _messagesSent + _messagesReceived;
+    return messages > 0 ? (double)(_documentsPushed + _documentsPulled) / messages : 0.0;
+}
+
+- (NSString*) description {
+    return [NSString stringWithFormat: @"%@[pushed=%llu (%.1f/sec), pulled=%llu (%.1f/sec), "
+            "errors=%llu, sent=%llu bytes, received=%llu bytes, rtt=%.3fs, conflicts=%llu/%llu, "
+            "filterTime=%.3fs]", self.class,
+            _documentsPushed, self.pushRate, _documentsPulled, self.pullRate, _documentErrors,
+            _bytesSent, _bytesReceived, _roundTripTime, _conflictsResolved,
+            _conflictsResolved + _conflictsFailed, _filterTime];
+}
+
+@end
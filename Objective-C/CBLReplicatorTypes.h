@@ -20,7 +20,7 @@
 #pragma once
 #import "CBLDocumentFlags.h"
 
-@class CBLDocument;
+@class CBLDocument, CBLReplicatedRevision;
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -51,4 +51,7 @@ typedef NS_ENUM(NSUInteger, CBLReplicatorType) {
 /** Replication Filter */
 typedef BOOL (^CBLReplicationFilter) (CBLDocument* document, CBLDocumentFlags flags);
 
+/** Replication Revision Filter, which reads the revision without creating a document. */
+typedef BOOL (^CBLReplicationRevisionFilter) (CBLReplicatedRevision* revision);
+
 NS_ASSUME_NONNULL_END
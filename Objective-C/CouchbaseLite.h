@@ -55,10 +55,12 @@ FOUNDATION_EXPORT const unsigned char CouchbaseLiteVersionString[];
 #import "CBLIndex.h"
 #import "CBLIndexable.h"
 #import "CBLIndexBuilder.h"
+#import "CBLKeyPath.h"
 #import "CBLListenerToken.h"
 #import "CBLLog.h"
 #import "CBLLogger.h"
 #import "CBLLogFileConfiguration.h"
+#import "CBLMaintenanceTask.h"
 #import "CBLQueryChange.h"
 #import "CBLMutableArray.h"
 #import "CBLMutableArrayFragment.h"
@@ -86,9 +88,11 @@ FOUNDATION_EXPORT const unsigned char CouchbaseLiteVersionString[];
 #import "CBLQueryResultSet.h"
 #import "CBLQuerySelectResult.h"
 #import "CBLQueryVariableExpression.h"
+#import "CBLReplicatedRevision.h"
 #import "CBLReplicator.h"
 #import "CBLReplicatorChange.h"
 #import "CBLReplicatorConfiguration.h"
+#import "CBLReplicatorMetrics.h"
 #import "CBLScope.h"
 #import "CBLSessionAuthenticator.h"
 #import "CBLURLEndpoint.h"
@@ -57,6 +57,12 @@ NS_ASSUME_NONNULL_BEGIN
               withConflictResolver: (nullable id<CBLConflictResolver>)conflictResolver
                              error: (NSError**)outError;
 
+/** Resolves the conflicts in a batch of documents. The local and remote revisions are all read
+    under one lock, and the resolved revisions are saved in one transaction. Returns an array
+    with, for each docID, either NSNull on success or the NSError. */
+- (NSArray*) resolveConflictsInDocuments: (NSArray<NSString*>*)docIDs
+                    withConflictResolver: (nullable id<CBLConflictResolver>)conflictResolver;
+
 @end
 
 @interface CBLCollectionChange ()
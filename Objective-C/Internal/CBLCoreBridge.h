@@ -67,7 +67,7 @@ public:
 private:
     C4Database *_db;
     C4Error _error;
-    bool _active;
+    bool _active {false};
 };
 
 NS_ASSUME_NONNULL_END
@@ -39,6 +39,12 @@
 
 struct c4BlobStore;
 
+#ifdef __cplusplus
+namespace cbl {
+    class SharedKeyStrings;
+}
+#endif
+
 @class CBLBlobStream;
 
 NS_ASSUME_NONNULL_BEGIN
@@ -47,12 +53,26 @@ NS_ASSUME_NONNULL_BEGIN
 /// CBLDatabase:
 
 
+/** Time in seconds spent in each phase of -initWithName:config:error:. */
+typedef struct {
+    double logSetup;            ///< Setting up logging (only nonzero for the first database)
+    double directory;           ///< Creating the database's parent directory
+    double c4Open;              ///< c4db_openNamed
+    double defaultCollection;   ///< Looking up the default collection
+    double total;               ///< The whole initializer, including the phases above
+} CBLDatabaseOpenTimings;
+
+
 @interface CBLDatabase () <CBLLockable, CBLRemovableListenerToken>
 
 @property (readonly, nonatomic, nullable) C4Database* c4db;
 @property (readonly, nonatomic) dispatch_queue_t dispatchQueue;
 @property (readonly, nonatomic) dispatch_queue_t queryQueue;
 @property (readonly, nonatomic) FLSharedKeys sharedKeys;
+#ifdef __cplusplus
+@property (readonly, nonatomic) cbl::SharedKeyStrings* sharedKeyStrings;
+#endif
+@property (readonly, nonatomic) CBLDatabaseOpenTimings openTimings;
 
 - (void) mustBeOpenLocked;
 - (BOOL) isClosedLocked;
@@ -28,6 +28,7 @@
 #import "CBLMutableFragment.h"
 #import "CBLArray.h"
 #import "CBLDocument.h"
+#import "CBLDocument+Fleece.h"
 #import "CBLDictionary.h"
 #import "CBLFragment.h"
 #import "fleece/Fleece.h"
@@ -66,7 +67,11 @@ NS_ASSUME_NONNULL_BEGIN
 
 @property (readonly, nonatomic) BOOL isDeleted;
 
-@property (nonatomic, readonly, nullable) FLDict fleeceData;
+// The properties, loading the revision body first if only the metadata has been read so far.
+@property (nonatomic, readonly) CBLDictionary* loadedDict;
+
+// YES if the properties have been modified since the document was loaded.
+@property (nonatomic, readonly) BOOL changed;
 
 - (instancetype) initWithCollection: (nullable CBLCollection*)collection
                          documentID: (NSString*)documentID
@@ -104,6 +109,11 @@ NS_ASSUME_NONNULL_BEGIN
 // Replace c4doc without updating the document data
 - (void) replaceC4Doc: (nullable CBLC4Document*)c4doc;
 
+// Replace the document data with the parsed JSON. The parsed Fleece data is used as the backing
+// store, so the properties are only converted to Objective-C objects when they're accessed, and
+// only the mutated ones are encoded from Objective-C objects when saving.
+- (BOOL) setContentWithJSON: (NSString*)json error: (NSError**)outError;
+
 @end
 
 //////////////////
@@ -36,6 +36,12 @@
     if (self) {
         _col = collection;
         _docID = documentID;
+        if (collection.db.config.readOnly) {
+            // Observers can't be created on a read-only connection, so changes made through a
+            // writable connection to the same file won't be reported to this listener:
+            CBLWarn(Database, @"%@ Read-only database; the change listener won't be called", self);
+            return self;
+        }
         CBLStringBytes bDocID(documentID);
         C4Error c4err = {};
         _obs = c4docobs_createWithCollection(collection.c4col,
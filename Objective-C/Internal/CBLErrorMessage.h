@@ -70,8 +70,6 @@ extern NSString* const kCBLErrorMessageDocumentNotFoundInCollection;
 extern NSString* const kCBLErrorMessageDocumentAnotherCollection;
 extern NSString* const kCBLErrorMessageInvalidBlob;
 extern NSString* const kCBLErrorMessageCollectionNotFoundDuringConflict;
-extern NSString* const kCBLErrorMessageConfigNotFoundDuringConflict;
-extern NSString* const kCBLErrorMessageCollectionNotFoundInFilter;
 extern NSString* const kCBLErrorMessageQueryFromInvalidDB;
 extern NSString* const kCBLErrorMessageEncodeFailureInvalidQuery;
 extern NSString* const kCBLErrorMessageNoDefaultCollectionInConfig;
@@ -68,8 +68,6 @@ NSString* const kCBLErrorMessageDocumentNotFoundInCollection = @"The document do
 NSString* const kCBLErrorMessageDocumentAnotherCollection = @"Cannot operate on a document from another collection.";
 NSString* const kCBLErrorMessageInvalidBlob = @"The given blob's metadata might be missing the digest / @type key or containing invalid values.";
 NSString* const kCBLErrorMessageCollectionNotFoundDuringConflict = @"Collection not found in replicator config when resolving a conflict.";
-NSString* const kCBLErrorMessageConfigNotFoundDuringConflict = @"Collection config not found in replicator config when resolving a conflict.";
-NSString* const kCBLErrorMessageCollectionNotFoundInFilter = @"Collection is not found in the replicator config when calling the filter function.";
 NSString* const kCBLErrorMessageQueryFromInvalidDB = @"Attempt to query from an invalid database.";
 NSString* const kCBLErrorMessageEncodeFailureInvalidQuery = @"Invalid query parameter, failed to encode.";
 NSString* const kCBLErrorMessageNoDefaultCollectionInConfig = @"No default collection added to the configuration.";
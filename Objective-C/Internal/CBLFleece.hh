@@ -24,6 +24,9 @@
 #import "MArray.hh"
 #import "MDict.hh"
 #import "CBLDocument.h"
+#import <mutex>
+#import <unordered_map>
+#import <vector>
 
 @class CBLDatabase, CBLC4Document;
 
@@ -49,25 +52,82 @@ namespace cbl {
     long long asLongLong(const fleece::MValue<id>&, const fleece::MCollection<id> &container);
     float     asFloat   (const fleece::MValue<id>&, const fleece::MCollection<id> &container);
     double    asDouble  (const fleece::MValue<id>&, const fleece::MCollection<id> &container);
+    NSDate* __nullable asDate(const fleece::MValue<id>&, const fleece::MCollection<id> &container);
+    
+    // These check the Fleece value's type first, returning nil without instantiating anything
+    // if it's wrong. Strings and numbers are created directly and cached nowhere, since typed
+    // getters are mostly called once per value.
+    NSString* __nullable asString(const fleece::MValue<id>&, const fleece::MCollection<id> &container);
+    NSNumber* __nullable asNumber(const fleece::MValue<id>&, const fleece::MCollection<id> &container);
+    // For CBLArray, CBLDictionary and CBLBlob, which can only come from Fleece collections or data:
+    id __nullable asObjectOfClass(const fleece::MValue<id>&, const fleece::MCollection<id> &container,
+                                  Class asClass);
+    
+    // Parses a Fleece string as an ISO-8601 date, without creating an NSString. Returns nil if
+    // the value isn't a string or isn't a valid date.
+    NSDate* __nullable dateFromFleece(fleece::Value);
     
     // parses the JSON string, into NSObject(NSArray, NSDictionary)
     id parseJSON(const FLSlice json, NSError** error);
     
+    // converts the JSON string to Fleece data; returns a null slice on error
+    fleece::alloc_slice convertJSON(const FLSlice json, NSError** error);
+    
+    // Interns the NSStrings of a database's shared keys -- the small integers Fleece substitutes
+    // for common dictionary keys -- so that all documents and query results share one string per
+    // key. Entries are checked against the key's string, since a key added in a transaction
+    // that's aborted can later be reused for a different string. Thread-safe.
+    class SharedKeyStrings {
+    public:
+        // Returns the string for shared key `key`, whose UTF-8 form is `keyString`, or nil if
+        // the key is out of range.
+        NSString* __nullable get(int key, fleece::slice keyString);
+        
+    private:
+        struct Entry {
+            fleece::alloc_slice bytes;
+            NSString* __nullable string;
+        };
+        std::mutex _mutex;
+        std::vector<Entry> _entries;
+    };
+    
     // Doc Context
     class DocContext : public fleece::MContext {
     public:
         DocContext(CBLDatabase *db, CBLC4Document* __nullable doc);
         
+        // For content that isn't (yet) in a database, like a document created from JSON.
+        // The context keeps the Fleece data alive.
+        DocContext(CBLDatabase* __nullable db, CBLC4Document* __nullable doc,
+                   const fleece::alloc_slice &data);
+        
+        ~DocContext();
+        
+        // A context is created and destroyed for every document that's read, so freed contexts
+        // and their string tables are kept in a small pool and reused.
+        static void* operator new(size_t size);
+        static void operator delete(void *ptr, size_t size);
+        
         CBLDatabase* database() const   {return _db;}
         CBLC4Document* __nullable document() const {return _doc;}
-        NSMapTable* fleeceToNSStrings() const {return _fleeceToNSStrings;}
+        NSMapTable* fleeceToNSStrings() const;      // Created on first use
+        SharedKeyStrings* __nullable sharedKeyStrings() const {return _sharedKeyStrings;}
         
         id toObject(fleece::Value);
         
+        // Same as dateFromFleece(), but remembers the result for each value, since the Fleece
+        // data doesn't change as long as this context exists.
+        NSDate* __nullable toDate(fleece::Value);
+        
         private:
         CBLDatabase *_db;
         CBLC4Document* __nullable _doc;
-        NSMapTable* _fleeceToNSStrings;
+        mutable std::once_flag _fleeceToNSStringsOnce;
+        mutable NSMapTable* __nullable _fleeceToNSStrings;
+        SharedKeyStrings* __nullable _sharedKeyStrings; // Owned by _db
+        std::mutex _datesMutex;
+        std::unordered_map<FLValue, NSDate*> _dates;
     };
 }
 
@@ -18,6 +18,7 @@
 //
 
 #import "CBLFleece.hh"
+#import "CBLCoreBridge.h"
 #import "CBLData.h"
 #import "CBLDatabase+Internal.h"
 #import "CBLDocument+Internal.h"
@@ -25,6 +26,7 @@
 #import "MDictIterator.hh"
 #import "c4Document+Fleece.h"
 #import "CBLStatus.h"
+#import "ParseDate.hh"
 
 @implementation NSObject (CBLFleece)
 - (fleece::MCollection<id>*) fl_collection {
@@ -33,16 +35,115 @@
 @end
 
 namespace cbl {
+    // Pool of freed DocContext memory blocks and emptied string tables. It's never destroyed,
+    // so that contexts released during process exit can still use it.
+    struct ContextPool {
+        static constexpr size_t kMaxSize = 64;
+        std::mutex mutex;
+        std::vector<void*> contexts;
+        std::vector<NSMapTable*> stringTables;
+    };
+    
+    static ContextPool& contextPool() {
+        static ContextPool* sPool = new ContextPool;
+        return *sPool;
+    }
+    
     DocContext::DocContext(CBLDatabase *db, CBLC4Document *doc)
     :fleece::MContext(fleece::alloc_slice())
     ,_db(db)
     ,_doc(doc)
-    ,_fleeceToNSStrings(FLCreateSharedStringsTable())
+    ,_sharedKeyStrings(db.sharedKeyStrings)
+    { }
+    
+    DocContext::DocContext(CBLDatabase *db, CBLC4Document *doc, const fleece::alloc_slice &data)
+    :fleece::MContext(data)
+    ,_db(db)
+    ,_doc(doc)
+    ,_sharedKeyStrings(db.sharedKeyStrings)
     { }
     
+    DocContext::~DocContext() {
+        if (_fleeceToNSStrings) {
+            // The table's keys point into this context's Fleece data, so empty it before reuse:
+            [_fleeceToNSStrings removeAllObjects];
+            ContextPool &pool = contextPool();
+            std::lock_guard<std::mutex> lock(pool.mutex);
+            if (pool.stringTables.size() < ContextPool::kMaxSize)
+                pool.stringTables.push_back(_fleeceToNSStrings);
+        }
+    }
+    
+    void* DocContext::operator new(size_t size) {
+        // Subclasses like QueryResultContext are bigger, and aren't pooled:
+        if (size == sizeof(DocContext)) {
+            ContextPool &pool = contextPool();
+            std::lock_guard<std::mutex> lock(pool.mutex);
+            if (!pool.contexts.empty()) {
+                void *ptr = pool.contexts.back();
+                pool.contexts.pop_back();
+                return ptr;
+            }
+        }
+        return ::operator new(size);
+    }
+    
+    void DocContext::operator delete(void *ptr, size_t size) {
+        if (size == sizeof(DocContext)) {
+            ContextPool &pool = contextPool();
+            std::lock_guard<std::mutex> lock(pool.mutex);
+            if (pool.contexts.size() < ContextPool::kMaxSize) {
+                pool.contexts.push_back(ptr);
+                return;
+            }
+        }
+        ::operator delete(ptr);
+    }
+    
+    NSMapTable* DocContext::fleeceToNSStrings() const {
+        // Most documents are only read through typed getters, which don't need the table:
+        std::call_once(_fleeceToNSStringsOnce, [this] {
+            NSMapTable* table = nil;
+            {
+                ContextPool &pool = contextPool();
+                std::lock_guard<std::mutex> lock(pool.mutex);
+                if (!pool.stringTables.empty()) {
+                    table = pool.stringTables.back();
+                    pool.stringTables.pop_back();
+                }
+            }
+            _fleeceToNSStrings = table ? table : FLCreateSharedStringsTable();
+        });
+        return _fleeceToNSStrings;
+    }
     
     id DocContext::toObject(fleece::Value value) {
-        return value.asNSObject(_fleeceToNSStrings);
+        return value.asNSObject(fleeceToNSStrings());
+    }
+    
+    NSString* SharedKeyStrings::get(int key, fleece::slice keyString) {
+        // Fleece never assigns more than 2048 shared keys:
+        if (key < 0 || key >= 2048 || !keyString)
+            return nil;
+        std::lock_guard<std::mutex> lock(_mutex);
+        if ((size_t)key >= _entries.size())
+            _entries.resize(key + 1);
+        Entry &entry = _entries[key];
+        if (!entry.string || entry.bytes != keyString) {
+            entry.bytes = fleece::alloc_slice(keyString);
+            entry.string = slice2string(keyString);
+        }
+        return entry.string;
+    }
+    
+    NSDate* DocContext::toDate(fleece::Value value) {
+        std::lock_guard<std::mutex> lock(_datesMutex);
+        auto i = _dates.find(value);
+        if (i != _dates.end())
+            return i->second;
+        NSDate* date = dateFromFleece(value);
+        _dates.emplace(value, date);
+        return date;
     }
 }
 
@@ -63,7 +164,10 @@ namespace fleece {
     static id createSpecialObjectOfType(Dict properties, DocContext *context) {
         slice type = properties.get(C4STR(kC4ObjectTypeProperty)).asString();
         if ((type && type == C4STR(kC4ObjectType_Blob)) || isOldAttachment(properties)) {
-            return [[CBLBlob alloc] initWithDatabase: context->database()
+            CBLDatabase* db = context->database();
+            if (!db)
+                return [[CBLBlob alloc] initWithProperties: context->toObject(properties)];
+            return [[CBLBlob alloc] initWithDatabase: db
                                           properties: context->toObject(properties)];
         }
         return nil;
@@ -116,8 +220,16 @@ namespace fleece {
         if (_iteratingMap) {
             return key().asNSString();
         } else {
-            auto sharedStrings = ((DocContext*)_dict.context())->fleeceToNSStrings();
-            return _dictIter.keyAsNSString(sharedStrings);
+            auto context = (DocContext*)_dict.context();
+            if (SharedKeyStrings* keyStrings = context->sharedKeyStrings()) {
+                Value key = _dictIter.key();
+                if (key.isInteger()) {
+                    NSString* str = keyStrings->get((int)key.asInt(), _dictIter.keyString());
+                    if (str)
+                        return str;
+                }
+            }
+            return _dictIter.keyAsNSString(context->fleeceToNSStrings());
         }
     }
 }
@@ -126,13 +238,18 @@ namespace cbl {
     using namespace fleece;
 
     bool valueWouldChange(id newValue, const MValue<id> &oldValue, MCollection<id> &container) {
-        // As a simplification we assume that array and dict values are always different, to avoid
-        // a possibly expensive comparison.
-        auto oldType = oldValue.value().type();
-        if (oldType == kFLUndefined || oldType == kFLDict || oldType == kFLArray)
+        if (oldValue.isEmpty())
             return true;
-        else if ([newValue isKindOfClass: [CBLArray class]]
-                || [newValue isKindOfClass: [CBLDictionary class]])
+        if ([newValue isKindOfClass: [CBLArray class]]
+                || [newValue isKindOfClass: [CBLDictionary class]]) {
+            // Putting a collection back into the slot it came from isn't a change; anything that
+            // was modified inside it has already marked the container as mutated. As a
+            // simplification other collections are assumed to be different, to avoid a possibly
+            // expensive comparison.
+            return newValue != oldValue.asNative(&container);
+        }
+        auto oldType = oldValue.value().type();
+        if (oldType == kFLDict || oldType == kFLArray)
             return true;
         else
             return ![newValue isEqual: oldValue.asNative(&container)];
@@ -173,14 +290,69 @@ namespace cbl {
             return asDouble(val.asNative(&container));
     }
 
+    NSDate* asDate(const MValue<id> &val, const MCollection<id> &container) {
+        Value value = val.value();
+        if (!value)
+            return asDate(val.asNative(&container));
+        if (value.type() != kFLString)
+            return nil;
+        return ((DocContext*)container.context())->toDate(value);
+    }
+
+    NSString* asString(const MValue<id> &val, const MCollection<id> &container) {
+        Value value = val.value();
+        if (!value)
+            return asString(val.asNative(&container));
+        if (value.type() != kFLString)
+            return nil;
+        return slice2string(value.asString());
+    }
+    
+    NSNumber* asNumber(const MValue<id> &val, const MCollection<id> &container) {
+        Value value = val.value();
+        if (!value)
+            return asNumber(val.asNative(&container));
+        FLValueType type = value.type();
+        if (type != kFLNumber && type != kFLBoolean)
+            return nil;
+        return value.asNSObject();
+    }
+    
+    id asObjectOfClass(const MValue<id> &val, const MCollection<id> &container, Class asClass) {
+        Value value = val.value();
+        if (value) {
+            FLValueType type = value.type();
+            if (type != kFLDict && type != kFLArray && type != kFLData)
+                return nil;
+        }
+        id obj = val.asNative(&container);
+        return [obj isKindOfClass: asClass] ? obj : nil;
+    }
+    
+    NSDate* dateFromFleece(Value value) {
+        if (value.type() != kFLString)
+            return nil;
+        int64_t time = ParseISO8601Date(value.asString());
+        if (time == kInvalidDate)
+            return nil;
+        return [NSDate dateWithTimeIntervalSince1970: time / 1000.0];
+    }
+
     id parseJSON(const FLSlice json, NSError** error) {
+        alloc_slice data = convertJSON(json, error);
+        if (!data)
+            return nullptr;
+        return FLValue_GetNSObject(FLValue_FromData(data, kFLTrusted), nullptr);
+    }
+    
+    alloc_slice convertJSON(const FLSlice json, NSError** error) {
         FLError flEerror = {};
         Encoder enc;
         if (!FLEncoder_ConvertJSON(enc, json)) {
             flEerror = enc.error();
             CBLWarnError(Database, @"Error converting JSON (code = %d)", flEerror);
             createError(CBLErrorInvalidJSON, @"Error converting JSON", error);
-            return nullptr;
+            return {};
         }
         
         flEerror = {};
@@ -188,19 +360,14 @@ namespace cbl {
         if (flEerror != 0 || !result.buf) {
             CBLWarnError(Database, @"Error decoding JSON (code = %d) or empty result", flEerror);
             createError(CBLErrorInvalidJSON, @"Error decoding JSON", error);
-            return nullptr;
+            return {};
         }
         
         if (!result.buf) {
             createError(CBLErrorInvalidJSON, @"Parse result is empty", error);
-            return nullptr;
+            return {};
         }
         
-        // updated way!
-        FLDoc doc = FLDoc_FromResultData(result, kFLTrusted, nullptr, nullslice);
-        FLSliceResult_Release(result);
-        id r = FLValue_GetNSObject(FLDoc_GetRoot(doc), nullptr);
-        FLDoc_Release(doc);
-        return r;
+        return alloc_slice(std::move(result));
     }
 }
@@ -75,13 +75,93 @@ static NSDateFormatter* getISO8601Formatter() {
     return sFormatter;
 }
 
+static inline char* putDigits(char* out, int value, int digits) {
+    for (int i = digits - 1; i >= 0; i--) {
+        out[i] = (char)('0' + value % 10);
+        value /= 10;
+    }
+    return out + digits;
+}
+
+static inline int64_t floorDiv(int64_t a, int64_t b) {
+    return (a >= 0 ? a : a - b + 1) / b;
+}
+
+// Formats a date the way the ISO-8601 formatter above does, but without any locking or
+// intermediate objects. `tzOffset` is the time zone's offset from GMT in seconds.
+// Returns nil if the date is outside the range it handles (the Gregorian calendar from 1600 to
+// 9999, where NSCalendar's and the proleptic Gregorian calendar agree) or the offset isn't a
+// whole number of minutes; the caller should then fall back to NSDateFormatter.
+static NSString* formatISO8601Date(NSDate* date, NSInteger tzOffset) {
+    // Truncate to milliseconds, like NSDateFormatter:
+    double millis = floor((date.timeIntervalSinceReferenceDate
+                           + kCFAbsoluteTimeIntervalSince1970) * 1000.0);
+    if (!(fabs(millis) < 1e15) || tzOffset % 60 != 0)
+        return nil;
+    
+    int64_t time = (int64_t)millis + (int64_t)tzOffset * 1000;
+    int64_t secs = floorDiv(time, 1000);
+    int ms = (int)(time - secs * 1000);
+    int64_t days = floorDiv(secs, 86400);
+    int secOfDay = (int)(secs - days * 86400);
+    
+    // Civil date from days since 1970-01-01 (H. Hinnant's algorithm):
+    int64_t z = days + 719468;
+    int64_t era = floorDiv(z, 146097);
+    int64_t doe = z - era * 146097;
+    int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int64_t mp = (5 * doy + 2) / 153;
+    int day = (int)(doy - (153 * mp + 2) / 5 + 1);
+    int month = (int)(mp < 10 ? mp + 3 : mp - 9);
+    int64_t year = yoe + era * 400 + (month <= 2);
+    if (year < 1600 || year > 9999)
+        return nil;
+    
+    // "uuuu-MM-dd'T'HH:mm:ss.SSSXXX":
+    char buf[32];
+    char* p = putDigits(buf, (int)year, 4);
+    *p++ = '-';
+    p = putDigits(p, month, 2);
+    *p++ = '-';
+    p = putDigits(p, day, 2);
+    *p++ = 'T';
+    p = putDigits(p, secOfDay / 3600, 2);
+    *p++ = ':';
+    p = putDigits(p, secOfDay / 60 % 60, 2);
+    *p++ = ':';
+    p = putDigits(p, secOfDay % 60, 2);
+    *p++ = '.';
+    p = putDigits(p, ms, 3);
+    if (tzOffset == 0) {
+        *p++ = 'Z';
+    } else {
+        *p++ = tzOffset < 0 ? '-' : '+';
+        int offsetMinutes = (int)(labs(tzOffset) / 60);
+        p = putDigits(p, offsetMinutes / 60, 2);
+        *p++ = ':';
+        p = putDigits(p, offsetMinutes % 60, 2);
+    }
+    return [[NSString alloc] initWithBytes: buf length: p - buf encoding: NSASCIIStringEncoding];
+}
+
 + (NSString*) JSONObjectWithDate: (NSDate*)date {
+    if (!date)
+        return nil;
+    NSString* result = formatISO8601Date(date, 0);
+    if (result)
+        return result;
     return [self JSONObjectWithDate:date timeZone:[NSTimeZone timeZoneForSecondsFromGMT:0]];
 }
 
 + (NSString*) JSONObjectWithDate: (NSDate*)date timeZone: (NSTimeZone*)tz {
     if (!date)
         return nil;
+    NSString* result = formatISO8601Date(date, [tz secondsFromGMTForDate: date]);
+    if (result)
+        return result;
+    
+    // Unusual dates go through the (slower, serialized) NSDateFormatter:
     @synchronized(self) {
         NSDateFormatter *formatter = getISO8601Formatter();
         formatter.timeZone = tz;
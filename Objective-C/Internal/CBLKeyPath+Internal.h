@@ -0,0 +1,50 @@
+//
+//  CBLKeyPath+Internal.h
+//  CouchbaseLite
+//
+//  Copyright (c) 2022 Couchbase, Inc All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#pragma once
+#import "CBLKeyPath.h"
+#import "fleece/Fleece.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface CBLKeyPath ()
+
+/** The first component, if it's a key. */
+@property (readonly, nonatomic, nullable) NSString* firstKey;
+
+/** The first component, if it's an array index; otherwise NSNotFound. */
+@property (readonly, nonatomic) NSInteger firstIndex;
+
+/** Evaluates the path without its first component against Fleece data encoded with the given
+    shared keys. Returns NULL if the path doesn't exist. */
+- (nullable FLValue) evaluateFleeceAfterFirst: (nullable FLValue)root
+                                   sharedKeys: (nullable FLSharedKeys)sharedKeys;
+
+/** Evaluates the path by walking dictionary and array objects (CBLDictionary, CBLArray and their
+    Foundation counterparts.) This is for data with unsaved changes, which isn't all in Fleece. */
+- (nullable id) evaluateObject: (nullable id)root;
+
+@end
+
+/** Returns the key path for a string, raising NSInvalidArgumentException if it's invalid.
+    Recently used paths are cached, so that -valueAtKeyPath: doesn't parse the same string over
+    and over. */
+CBLKeyPath* CBLKeyPathForString(NSString* path);
+
+NS_ASSUME_NONNULL_END
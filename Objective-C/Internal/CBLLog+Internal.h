@@ -29,6 +29,12 @@ NS_ASSUME_NONNULL_BEGIN
 
 - (void) synchronizeCallbackLogLevel;
 
+/** Recomputes the per-domain levels checked by the CBLLog... macros. Call after any change to
+    the domain, file or callback log levels. */
+- (void) updateEffectiveLogLevels;
+
+- (BOOL) shouldLogToCallback: (CBLLogLevel)level;
+
 @end
 
 @interface CBLConsoleLogger ()
@@ -39,10 +39,20 @@ extern C4LogDomain kCBL_LogDomainQuery;
 extern C4LogDomain kCBL_LogDomainSync;
 extern C4LogDomain kCBL_LogDomainWebSocket;
 extern C4LogDomain kCBL_LogDomainListener;
+
+// Lowest level that will be written anywhere (file, console or custom logger) for each domain.
+// These are kept up to date by CBLLog whenever a log level changes, so that disabled log calls
+// cost only a load and a branch, without formatting the message or calling into LiteCore.
+extern C4LogLevel kCBL_LogLevelDefault;
+extern C4LogLevel kCBL_LogLevelDatabase;
+extern C4LogLevel kCBL_LogLevelQuery;
+extern C4LogLevel kCBL_LogLevelSync;
+extern C4LogLevel kCBL_LogLevelWebSocket;
+extern C4LogLevel kCBL_LogLevelListener;
     
 // Logging functions. For the domain, just use the part of the name between kCBL… and …LogDomain.
 #define CBLLogToAt(DOMAIN, LEVEL, FMT, ...)        \
-        ({if (__builtin_expect(c4log_getLevel(kCBL_LogDomain##DOMAIN) <= LEVEL, false))   \
+        ({if (__builtin_expect(kCBL_LogLevel##DOMAIN <= LEVEL, false))   \
               cblLog(kCBL_LogDomain##DOMAIN, LEVEL, FMT, ## __VA_ARGS__);})
 #define CBLLogVerbose(DOMAIN, FMT, ...) CBLLogToAt(DOMAIN, kC4LogVerbose, FMT, ## __VA_ARGS__)
 #define CBLLogInfo(DOMAIN, FMT, ...)    CBLLogToAt(DOMAIN, kC4LogInfo,    FMT, ## __VA_ARGS__)
@@ -0,0 +1,40 @@
+//
+//  CBLMaintenanceTask+Internal.h
+//  CouchbaseLite
+//
+//  Copyright (c) 2022 Couchbase, Inc All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#pragma once
+#import "CBLMaintenanceTask.h"
+#import "CBLStoppable.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface CBLMaintenanceTask () <CBLStoppable>
+
+- (instancetype) initWithDatabase: (CBLDatabase*)database
+                             type: (CBLMaintenanceType)type
+                        timeSlice: (NSTimeInterval)timeSlice
+                            queue: (dispatch_queue_t)queue
+                         progress: (nullable void (^)(double progress))progress
+                       completion: (void (^)(NSError* _Nullable error))completion;
+
+/** Schedules the first step. The database must have registered the task as active stoppable. */
+- (void) start;
+
+@end
+
+NS_ASSUME_NONNULL_END
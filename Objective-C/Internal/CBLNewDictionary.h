@@ -23,7 +23,9 @@ NS_ASSUME_NONNULL_BEGIN
 
 
 /** An implementation of a CBLMutableDictionary with no storage, i.e. that's just been added to a doc.
-     This class is an optimization that does less work than the regular CBLMutableDictionary. */
+     This class is an optimization that does less work than the regular CBLMutableDictionary.
+     Properties are kept in a vector in the order they were added, with scalars from the typed
+     setters stored unboxed, and are written straight to the Fleece encoder when saving. */
 @interface CBLNewDictionary : NSObject <CBLMutableDictionary>
 
 @property (weak, nonatomic, nullable) id swiftObject;
@@ -23,80 +23,254 @@
 #import "CBLMutableArray.h"
 #import "CBLBlob.h"
 #import "CBLJSON.h"
+#import "CBLKeyPath+Internal.h"
 #import "CBLMutableFragment.h"
 #import "CBLDocument+Internal.h"
 #import "CBLStatus.h"
 #import "CBLFleece.hh"
 #import "CBLStringBytes.h"
 #import "CBLCoreBridge.h"
+#import <vector>
 
 using namespace cbl;
 using namespace fleece;
 
+namespace {
+
+    // One property of a CBLNewDictionary. Scalars set through the typed setters are stored
+    // inline, so they don't have to be boxed into NSNumbers; everything else is an object.
+    struct Property {
+        enum Type : uint8_t {kObject, kInteger, kDouble, kFloat, kBoolean};
+
+        NSString* key;
+        id object;                      // Only used by kObject
+        union {
+            long long integer;
+            double dbl;
+            float flt;
+            bool boolean;
+        };
+        Type type;
+
+        Property(NSString* k, id obj)           :key(k), object(obj), integer(0), type(kObject) { }
+        Property(NSString* k, long long i)      :key(k), integer(i), type(kInteger) { }
+        Property(NSString* k, double d)         :key(k), dbl(d), type(kDouble) { }
+        Property(NSString* k, float f)          :key(k), flt(f), type(kFloat) { }
+        Property(NSString* k, bool b)           :key(k), boolean(b), type(kBoolean) { }
+
+        bool isScalar() const                   {return type != kObject;}
+
+        id boxed() const {
+            switch (type) {
+                case kObject:   return object;
+                case kInteger:  return @(integer);
+                case kDouble:   return @(dbl);
+                case kFloat:    return @(flt);
+                case kBoolean:  return @(boolean);
+            }
+        }
+
+        long long asLongLong() const {
+            switch (type) {
+                case kObject:   return cbl::asLongLong(object);
+                case kInteger:  return integer;
+                case kDouble:   return (long long)dbl;
+                case kFloat:    return (long long)flt;
+                case kBoolean:  return boolean;
+            }
+        }
+
+        double asDouble() const {
+            switch (type) {
+                case kObject:   return cbl::asDouble(object);
+                case kInteger:  return (double)integer;
+                case kDouble:   return dbl;
+                case kFloat:    return flt;
+                case kBoolean:  return boolean;
+            }
+        }
+
+        bool asBool() const {
+            switch (type) {
+                case kObject:   return cbl::asBool(object);
+                case kInteger:  return integer != 0;
+                case kDouble:   return dbl != 0.0;
+                case kFloat:    return flt != 0.0f;
+                case kBoolean:  return boolean;
+            }
+        }
+
+        bool sameValueAs(const Property &other) const {
+            if (type == other.type) {
+                switch (type) {
+                    case kObject:   return object == other.object || [object isEqual: other.object];
+                    case kInteger:  return integer == other.integer;
+                    case kDouble:   return dbl == other.dbl;
+                    case kFloat:    return flt == other.flt;
+                    case kBoolean:  return boolean == other.boolean;
+                }
+            }
+            return [boxed() isEqual: other.boxed()];
+        }
+
+        void encodeTo(FLEncoder enc) const {
+            CBLStringBytes keyBytes(key);
+            FLEncoder_WriteKey(enc, keyBytes);
+            switch (type) {
+                case kObject:
+                    if ([object isKindOfClass: [NSString class]]) {
+                        CBLStringBytes str(object);
+                        FLEncoder_WriteString(enc, str);
+                    } else if (object == [NSNull null]) {
+                        FLEncoder_WriteNull(enc);
+                    } else {
+                        FLEncoder_WriteNSObject(enc, object);
+                    }
+                    break;
+                case kInteger:  FLEncoder_WriteInt(enc, integer); break;
+                case kDouble:   FLEncoder_WriteDouble(enc, dbl); break;
+                case kFloat:    FLEncoder_WriteFloat(enc, flt); break;
+                case kBoolean:  FLEncoder_WriteBool(enc, boolean); break;
+            }
+        }
+    };
+
+    // Above this many properties, lookups go through an index instead of a linear search.
+    constexpr size_t kMaxLinearSearch = 16;
+
+}
+
 @interface CBLNewDictionary()
 @end
 
 @implementation CBLNewDictionary
 {
-    NSMutableDictionary* _dict;
+    std::vector<Property> _properties;                 // In the order they were added
+    NSMutableDictionary<NSString*,NSNumber*>* _index;  // Key -> position; only for large dicts
+    NSArray* _keys;
+    NSArray* _enumeratedKeys;                          // Keys being fast-enumerated
+    unsigned long _mutations;                          // Bumped when a key is added or removed
     BOOL _changed;
 }
 
 @synthesize swiftObject=_swiftObject;
 
-- (instancetype) init {
+- (instancetype) initWithDictionary: (NSDictionary*)dictionary {
     self = [super init];
     if (self) {
-        _dict = [NSMutableDictionary new];
+        _properties.reserve(dictionary.count);
+        [dictionary enumerateKeysAndObjectsUsingBlock: ^(NSString* key, id value, BOOL* stop) {
+            _properties.emplace_back([key copy], value);
+        }];
+        if (!_properties.empty())
+            _changed = YES;
     }
     return self;
 }
 
-- (instancetype) initWithDictionary: (NSDictionary*)dictionary {
+- (instancetype) initWithProperties: (const std::vector<Property>&)properties {
     self = [super init];
     if (self) {
-        _dict = [dictionary mutableCopy];
-        if (_dict.count > 0)
+        _properties = properties;
+        if (!_properties.empty())
             _changed = YES;
     }
     return self;
 }
 
 - (id) copyWithZone: (NSZone*)zone {
-    return [[[self class] alloc] initWithDictionary: _dict];
+    return [[[self class] alloc] initWithProperties: _properties];
 }
 
 - (CBLMutableDictionary*) mutableCopyWithZone: (NSZone*)zone {
-    return [[[self class] alloc] initWithDictionary: _dict];
+    return [[[self class] alloc] initWithProperties: _properties];
 }
 
 - (void) fl_encodeToFLEncoder: (FLEncoder)enc {
-    FLEncoder_WriteNSObject(enc, _dict);
+    FLEncoder_BeginDict(enc, _properties.size());
+    for (auto &prop : _properties)
+        prop.encodeTo(enc);
+    FLEncoder_EndDict(enc);
 }
 
 - (BOOL) changed {
     return _changed;
 }
 
+#pragma mark - Property Storage
+
+- (Property*) propertyForKey: (NSString*)key {
+    if (_properties.size() > kMaxLinearSearch) {
+        if (!_index) {
+            _index = [NSMutableDictionary dictionaryWithCapacity: _properties.size()];
+            for (NSUInteger i = 0; i < _properties.size(); ++i)
+                _index[_properties[i].key] = @(i);
+        }
+        NSNumber* i = _index[key];
+        return i ? &_properties[i.unsignedIntegerValue] : nullptr;
+    }
+    for (auto &prop : _properties) {
+        if (prop.key == key || [prop.key isEqualToString: key])
+            return &prop;
+    }
+    return nullptr;
+}
+
+- (void) setProperty: (Property&&)newProp {
+    if (Property* prop = [self propertyForKey: newProp.key]) {
+        if (prop->sameValueAs(newProp))
+            return;
+        prop->object = newProp.object;
+        prop->integer = newProp.integer;
+        prop->type = newProp.type;
+    } else {
+        newProp.key = [newProp.key copy];
+        if (_index)
+            _index[newProp.key] = @(_properties.size());
+        _properties.push_back(std::move(newProp));
+        _keys = nil;
+        ++_mutations;
+    }
+    _changed = true;
+}
+
+- (void) replaceAllProperties {
+    _properties.clear();
+    _index = nil;
+    _keys = nil;
+    ++_mutations;
+}
+
 #pragma mark - Counting Entries
 
 - (NSUInteger) count {
-    return _dict.count;
+    return _properties.size();
 }
 
 #pragma mark - Accessing Keys
 
 - (NSArray*) keys {
-    return _dict.allKeys;
+    if (!_keys) {
+        NSMutableArray* keys = [NSMutableArray arrayWithCapacity: _properties.size()];
+        for (auto &prop : _properties)
+            [keys addObject: prop.key];
+        _keys = keys;
+    }
+    return _keys;
 }
 
 #pragma mark - Type Getters
 
 - (nullable id) objectForKey: (NSString*)key {
-    id obj = _dict[key];
+    Property* prop = [self propertyForKey: key];
+    if (!prop)
+        return nil;
+    if (prop->isScalar())
+        return prop->boxed();
+    id obj = prop->object;
     id cblObj = [obj cbl_toCBLObject];
     if (cblObj != obj && [cblObj class] != [obj class])
-        _dict[key] = cblObj;
+        prop->object = cblObj;
     return cblObj;
 }
 
@@ -105,35 +279,43 @@ using namespace fleece;
 }
 
 - (nullable NSString*) stringForKey: (NSString*)key {
-    return asString(_dict[key]);
+    Property* prop = [self propertyForKey: key];
+    return (prop && !prop->isScalar()) ? asString(prop->object) : nil;
 }
 
 - (nullable NSNumber*) numberForKey: (NSString*)key {
-    return asNumber(_dict[key]);
+    Property* prop = [self propertyForKey: key];
+    return prop ? asNumber(prop->boxed()) : nil;
 }
 
 - (NSInteger) integerForKey: (NSString*)key {
-    return asInteger(_dict[key]);
+    Property* prop = [self propertyForKey: key];
+    return prop ? (NSInteger)prop->asLongLong() : 0;
 }
 
 - (long long) longLongForKey: (NSString*)key {
-    return asLongLong(_dict[key]);
+    Property* prop = [self propertyForKey: key];
+    return prop ? prop->asLongLong() : 0;
 }
 
 - (float) floatForKey: (NSString*)key {
-    return asFloat(_dict[key]);
+    Property* prop = [self propertyForKey: key];
+    return prop ? (float)prop->asDouble() : 0.0f;
 }
 
 - (double) doubleForKey: (NSString*)key {
-    return asDouble(_dict[key]);
+    Property* prop = [self propertyForKey: key];
+    return prop ? prop->asDouble() : 0.0;
 }
 
 - (BOOL) booleanForKey: (NSString*)key {
-    return asBool(_dict[key]);
+    Property* prop = [self propertyForKey: key];
+    return prop ? prop->asBool() : NO;
 }
 
 - (nullable NSDate*) dateForKey: (NSString*)key {
-    return asDate(_dict[key]);
+    Property* prop = [self propertyForKey: key];
+    return (prop && !prop->isScalar()) ? asDate(prop->object) : nil;
 }
 
 - (nullable CBLBlob*) blobForKey: (NSString*)key {
@@ -151,7 +333,16 @@ using namespace fleece;
 #pragma mark - Check Existence
 
 - (BOOL) containsValueForKey: (NSString*)key {
-    return _dict[key] != nil;
+    return [self propertyForKey: key] != nullptr;
+}
+
+- (nullable id) valueAtKeyPath: (NSString*)path {
+    return [self valueAtCompiledKeyPath: CBLKeyPathForString(path)];
+}
+
+- (nullable id) valueAtCompiledKeyPath: (CBLKeyPath*)keyPath {
+    CBLAssertNotNil(keyPath);
+    return [keyPath evaluateObject: self];
 }
 
 #pragma mark - Type Setters
@@ -161,7 +352,8 @@ using namespace fleece;
 }
 
 - (void) setBoolean: (BOOL)value forKey: (NSString*)key {
-    [self setObject: @(value) forKey: key];
+    CBLAssertNotNil(key);
+    [self setProperty: Property(key, (bool)value)];
 }
 
 - (void) setBlob: (nullable CBLBlob*)value forKey: (NSString*)key {
@@ -177,19 +369,23 @@ using namespace fleece;
 }
 
 - (void) setDouble: (double)value forKey: (NSString*)key {
-    [self setObject: @(value) forKey: key];
+    CBLAssertNotNil(key);
+    [self setProperty: Property(key, value)];
 }
 
 - (void) setFloat: (float)value forKey: (NSString*)key {
-    [self setObject: @(value) forKey: key];
+    CBLAssertNotNil(key);
+    [self setProperty: Property(key, value)];
 }
 
 - (void) setInteger: (NSInteger)value forKey: (NSString*)key {
-    [self setObject: @(value) forKey: key];
+    CBLAssertNotNil(key);
+    [self setProperty: Property(key, (long long)value)];
 }
 
 - (void) setLongLong: (long long)value forKey: (NSString*)key {
-    [self setObject: @(value) forKey: key];
+    CBLAssertNotNil(key);
+    [self setProperty: Property(key, value)];
 }
 
 - (void) setNumber: (nullable NSNumber*)value forKey: (NSString*)key {
@@ -201,13 +397,10 @@ using namespace fleece;
 }
 
 - (void) setObject: (nullable id)value forKey: (NSString*)key {
+    CBLAssertNotNil(key);
     if (value == nil) value = [NSNull null]; // Store NSNull
     value = [value cbl_toCBLObject];
-    id oldValue = _dict[key];
-    if (value != oldValue && ![value isEqual: oldValue]) {
-        _dict[key] = value;
-        _changed = true;
-    }
+    [self setProperty: Property(key, (id)value)];
 }
 
 - (void) setString: (nullable NSString*)value forKey: (NSString*)key {
@@ -215,16 +408,22 @@ using namespace fleece;
 }
 
 - (void) removeValueForKey: (NSString*)key {
-    if (_dict[key]) {
-        [_dict removeObjectForKey: key];
+    CBLAssertNotNil(key);
+    Property* prop = [self propertyForKey: key];
+    if (prop) {
+        _properties.erase(_properties.begin() + (prop - _properties.data()));
+        _index = nil;
+        _keys = nil;
+        ++_mutations;
         _changed = true;
     }
 }
 
 - (void) setData: (NSDictionary<NSString*,id>*)data {
-    _dict = [NSMutableDictionary dictionaryWithCapacity: data.count];
-    [data enumerateKeysAndObjectsUsingBlock: ^(id key, id value, BOOL* stop) {
-        [_dict setObject:  [value cbl_toCBLObject] forKey: key];
+    [self replaceAllProperties];
+    _properties.reserve(data.count);
+    [data enumerateKeysAndObjectsUsingBlock: ^(NSString* key, id value, BOOL* stop) {
+        _properties.emplace_back([key copy], [value cbl_toCBLObject]);
     }];
     _changed = true;
 }
@@ -244,17 +443,20 @@ using namespace fleece;
         return createError(CBLErrorInvalidJSON, @"Parsed result is not a Dictionary", outError);
     }
     
-    _dict = [NSMutableDictionary dictionaryWithDictionary: (NSDictionary*)result];
+    [self replaceAllProperties];
+    _properties.reserve([result count]);
+    [(NSDictionary*)result enumerateKeysAndObjectsUsingBlock: ^(NSString* key, id value, BOOL* stop) {
+        _properties.emplace_back(key, value);
+    }];
     return YES;
 }
 
 #pragma mark - Convert to NSDictionary
 
 - (NSDictionary<NSString*,id>*) toDictionary {
-    NSMutableDictionary* result = [NSMutableDictionary dictionaryWithCapacity: _dict.count];
-    [_dict enumerateKeysAndObjectsUsingBlock: ^(id key, id obj, BOOL* stop) {
-        result[key] = [obj cbl_toPlainObject];
-    }];
+    NSMutableDictionary* result = [NSMutableDictionary dictionaryWithCapacity: _properties.size()];
+    for (auto &prop : _properties)
+        result[prop.key] = [prop.boxed() cbl_toPlainObject];
     return result;
 }
 
@@ -283,7 +485,21 @@ using namespace fleece;
                                   objects: (id __unsafe_unretained [])buffer
                                     count: (NSUInteger)len
 {
-    return [_dict countByEnumeratingWithState: state objects: buffer count: len];
+    if (state->state == 0) {
+        state->state = 1;
+        state->mutationsPtr = &_mutations;  // Adding or removing a key raises in the loop
+        state->extra[0] = 0;                // Next start index
+        // Adding or removing a key clears _keys, so hold onto the array being enumerated:
+        _enumeratedKeys = self.keys;
+    }
+    
+    NSArray* keys = _enumeratedKeys;
+    NSUInteger start = state->extra[0];
+    NSUInteger count = MIN(len, keys.count - MIN(start, keys.count));
+    [keys getObjects: buffer range: NSMakeRange(start, count)];
+    state->extra[0] = start + count;
+    state->itemsPtr = buffer;
+    return count;
 }
 
 #pragma mark - Subscript
@@ -303,15 +519,9 @@ using namespace fleece;
     if (self.count != other.count)
         return NO;
     
-    for (NSString* key in _dict) {
-        id value = _dict[key];
-        if (value) {
-            if (![value isEqual: [other valueForKey: key]])
-                return NO;
-        } else {
-            if ([other valueForKey: key] || ![other containsValueForKey: key])
-                return NO;
-        }
+    for (auto &prop : _properties) {
+        if (![prop.boxed() isEqual: [other valueForKey: prop.key]])
+            return NO;
     }
     
     return YES;
@@ -319,10 +529,8 @@ using namespace fleece;
 
 - (NSUInteger) hash {
     NSUInteger hash = 0;
-    for (NSString* key in _dict) {
-        id value = _dict[key];
-        hash += ([key hash] ^ [value hash]);
-    }
+    for (auto &prop : _properties)
+        hash += ([prop.key hash] ^ [prop.boxed() hash]);
     return hash;
 }
 
@@ -28,6 +28,11 @@
 
 @class MYBackgroundMonitor;
 
+// Replicator options handled by CBLWebSocket; not defined in c4Replicator.h:
+#define kCBLReplicatorOptionWSCompression           "CBLWSCompression"          // bool
+#define kCBLReplicatorOptionWSCompressionWindowBits "CBLWSCompressionWindowBits" // int, 9...15
+#define kCBLReplicatorOptionWSCompressionThreshold  "CBLWSCompressionThreshold" // int, bytes
+
 NS_ASSUME_NONNULL_BEGIN
 
 @interface CBLReplicatorConfiguration ()
@@ -35,6 +40,12 @@ NS_ASSUME_NONNULL_BEGIN
 @property (nonatomic, nullable) CBLDatabase* database;
 @property (readonly, nonatomic) NSDictionary* effectiveOptions;
 @property (nonatomic) NSTimeInterval checkpointInterval;
+
+// Conflict resolution pipeline (no public api now). The max number of resolver workers running
+// in parallel, and the max number of conflicts a worker resolves and saves in one transaction;
+// use defaults when set to zero.
+@property (nonatomic) NSUInteger maxConflictResolvers;
+@property (nonatomic) NSUInteger conflictResolutionBatchSize;
 @property (nonatomic) NSMutableDictionary<CBLCollection*, CBLCollectionConfiguration*>* collectionConfigs;
 
 #ifdef COUCHBASE_ENTERPRISE
@@ -47,6 +58,14 @@ NS_ASSUME_NONNULL_BEGIN
 @end
 
 
+/** Conflict resolution counters, for diagnostics and tests. */
+typedef struct {
+    uint64_t resolved;          ///< Number of conflicts resolved
+    uint64_t failed;            ///< Number of conflicts that failed to be resolved
+    uint64_t batches;           ///< Number of batches processed by the resolver workers
+    NSTimeInterval time;        ///< Total time the resolver workers spent, in seconds
+} CBLConflictResolutionStats;
+
 @interface CBLReplicatorStatus ()
 - (instancetype) initWithStatus: (C4ReplicatorStatus)c4Status;
 @end
@@ -60,6 +79,7 @@ NS_ASSUME_NONNULL_BEGIN
 @property (readonly, atomic) BOOL active;
 @property (nonatomic) MYBackgroundMonitor* bgMonitor;
 @property (readonly, atomic) dispatch_queue_t dispatchQueue;
+@property (readonly, atomic) CBLConflictResolutionStats conflictResolutionStats;
 
 // For CBLWebSocket to set the current server certificate
 @property (copy, atomic, nullable) __attribute__((NSObject)) SecCertificateRef serverCertificate;
@@ -0,0 +1,107 @@
+//
+//  CBLRingBuffer.hh
+//  CouchbaseLite
+//
+//  Copyright (c) 2022 Couchbase, Inc All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#pragma once
+#import <atomic>
+#import <cstddef>
+#import <cstdint>
+#import <memory>
+
+namespace cbl {
+
+    /** A bounded, lock-free, multi-producer multi-consumer FIFO queue (D. Vyukov's algorithm.)
+        Neither `push` nor `pop` ever blocks: `push` fails if the queue is full, and `pop` fails
+        if it's empty. T should be cheap to copy; it's copied in and out of the slots. */
+    template <class T>
+    class RingBuffer {
+    public:
+        /** @param capacity  Max number of items; rounded up to a power of two. */
+        explicit RingBuffer(size_t capacity)
+        {
+            size_t size = 2;
+            while (size < capacity)
+                size <<= 1;
+            _mask = size - 1;
+            _cells.reset(new Cell[size]);
+            for (size_t i = 0; i < size; i++)
+                _cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        RingBuffer(const RingBuffer&) =delete;
+        RingBuffer& operator=(const RingBuffer&) =delete;
+
+        size_t capacity() const                     {return _mask + 1;}
+
+        /** Adds an item at the tail. Returns false if the queue is full. */
+        bool push(const T &item) {
+            Cell *cell;
+            size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+            for (;;) {
+                cell = &_cells[pos & _mask];
+                size_t seq = cell->sequence.load(std::memory_order_acquire);
+                intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+                if (diff == 0) {
+                    if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                } else if (diff < 0) {
+                    return false;       // Full
+                } else {
+                    pos = _enqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+            cell->value = item;
+            cell->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        /** Removes the item at the head. Returns false if the queue is empty. */
+        bool pop(T &outItem) {
+            Cell *cell;
+            size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+            for (;;) {
+                cell = &_cells[pos & _mask];
+                size_t seq = cell->sequence.load(std::memory_order_acquire);
+                intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+                if (diff == 0) {
+                    if (_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                } else if (diff < 0) {
+                    return false;       // Empty
+                } else {
+                    pos = _dequeuePos.load(std::memory_order_relaxed);
+                }
+            }
+            outItem = cell->value;
+            cell->sequence.store(pos + _mask + 1, std::memory_order_release);
+            return true;
+        }
+
+    private:
+        struct Cell {
+            std::atomic<size_t> sequence;
+            T value;
+        };
+
+        std::unique_ptr<Cell[]> _cells;
+        size_t _mask;
+        alignas(64) std::atomic<size_t> _enqueuePos {0};
+        alignas(64) std::atomic<size_t> _dequeuePos {0};
+    };
+
+}
@@ -0,0 +1,101 @@
+//
+//  CBLTrace.hh
+//  CouchbaseLite
+//
+//  Copyright (c) 2022 Couchbase, Inc All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#pragma once
+#import <Foundation/Foundation.h>
+#import <atomic>
+#import <cstdint>
+
+NS_ASSUME_NONNULL_BEGIN
+
+namespace cbl {
+
+    /** Events recorded by the tracer. Keep in sync with the table in CBLTrace.mm. */
+    enum class TraceEvent : uint16_t {
+        CollectionSaveBegin,
+        CollectionSaveEnd,
+        QueryExecuteBegin,
+        QueryExecuteEnd,            // arg1: 1 if the query ran, else 0
+        QueryNextRowBegin,
+        QueryNextRowEnd,            // arg1: 1 if a row was returned, else 0
+        WebSocketRead,              // arg1: bytes read
+        WebSocketWrite,             // arg1: bytes written
+        ReplicatorStatus,           // arg1: C4ReplicatorActivityLevel, arg2: error code
+        kCount
+    };
+
+    namespace tracing {
+        extern std::atomic<bool> gEnabled;
+        void record(TraceEvent, int64_t arg1, int64_t arg2);
+    }
+
+    /** Low-overhead event tracing for diagnosing latency. Each thread records fixed-size binary
+        events (timestamp, thread, event, two integers) into its own ring buffer, which keeps the
+        most recent events; nothing is formatted until the trace is exported.
+        When tracing is disabled, a trace call is a single relaxed load and a branch. */
+    static inline bool tracingEnabled() {
+        return tracing::gEnabled.load(std::memory_order_relaxed);
+    }
+
+    static inline void trace(TraceEvent event, int64_t arg1 =0, int64_t arg2 =0) {
+        if (__builtin_expect(tracingEnabled(), false))
+            tracing::record(event, arg1, arg2);
+    }
+
+    /** Records a begin event when constructed and the matching end event when destructed. */
+    class TraceSpan {
+    public:
+        TraceSpan(TraceEvent begin, TraceEvent end)
+        :_end(end)
+        ,_active(tracingEnabled())
+        {
+            if (__builtin_expect(_active, false))
+                tracing::record(begin, 0, 0);
+        }
+
+        ~TraceSpan() {
+            if (__builtin_expect(_active, false))
+                tracing::record(_end, _arg1, _arg2);
+        }
+
+        /** Sets the arguments of the end event. */
+        void setResult(int64_t arg1, int64_t arg2 =0)   {_arg1 = arg1; _arg2 = arg2;}
+
+        TraceSpan(const TraceSpan&) =delete;
+        TraceSpan& operator=(const TraceSpan&) =delete;
+
+    private:
+        TraceEvent _end;
+        bool _active;
+        int64_t _arg1 {0}, _arg2 {0};
+    };
+
+    /** Turns tracing on or off. Events recorded so far are kept. */
+    void setTracingEnabled(bool enabled);
+
+    /** Discards all events recorded so far. */
+    void resetTrace();
+
+    /** Returns the recorded events in the Chrome trace event JSON format, which can be loaded
+        into chrome://tracing or Perfetto. Events recorded while this runs may be missing. */
+    NSData* exportChromeTrace();
+
+}
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,232 @@
+//
+//  CBLTrace.mm
+//  CouchbaseLite
+//
+//  Copyright (c) 2022 Couchbase, Inc All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import "CBLTrace.hh"
+#import <chrono>
+#import <mutex>
+#import <pthread.h>
+#import <string>
+#import <unistd.h>
+#import <vector>
+
+namespace cbl {
+
+    namespace tracing {
+        std::atomic<bool> gEnabled {false};
+    }
+
+    namespace {
+
+        struct EventInfo {
+            const char* name;
+            const char* category;
+            char phase;                 // Chrome trace phase: 'B'egin, 'E'nd, 'i'nstant
+            const char* arg1;           // Names of the arguments shown; null if unused
+            const char* arg2;
+        };
+
+        const EventInfo kEventInfo[] = {
+            {"Collection.save",     "db",    'B', nullptr, nullptr},
+            {"Collection.save",     "db",    'E', nullptr, nullptr},
+            {"Query.execute",       "query", 'B', nullptr, nullptr},
+            {"Query.execute",       "query", 'E', "ok",    nullptr},
+            {"QueryResultSet.next", "query", 'B', nullptr, nullptr},
+            {"QueryResultSet.next", "query", 'E', "row",   nullptr},
+            {"WebSocket.read",      "net",   'i', "bytes", nullptr},
+            {"WebSocket.write",     "net",   'i', "bytes", nullptr},
+            {"Replicator.status",   "sync",  'i', "level", "error"},
+        };
+        static_assert(sizeof(kEventInfo) / sizeof(kEventInfo[0]) == (size_t)TraceEvent::kCount,
+                      "kEventInfo doesn't match TraceEvent");
+
+        struct TraceRecord {
+            uint64_t time;              // Nanoseconds since the trace epoch
+            uint32_t thread;            // Trace thread ID
+            uint16_t event;             // TraceEvent
+            uint16_t reserved;
+            int64_t arg1, arg2;
+        };
+        static_assert(sizeof(TraceRecord) == 32, "TraceRecord should be 32 bytes");
+
+        constexpr size_t kRingSize = 8192;     // Records per thread (256KB)
+
+        // A thread's ring buffer. Only the owning thread writes to the records; when a thread
+        // exits, its ring (with the events in it) is handed to the next new thread, which takes
+        // over the name slot too, so the number of names is bounded by the number of rings.
+        struct ThreadRing {
+            TraceRecord records[kRingSize];
+            std::atomic<uint64_t> count {0};    // Total number of records ever written
+            uint32_t threadID {0};              // Current owner; guarded by TraceState::mutex
+            std::string threadName;             // Current owner; guarded by TraceState::mutex
+        };
+
+        // Shared state. Allocated once and never freed, since threads can still exit after
+        // static destructors have run.
+        struct TraceState {
+            std::mutex mutex;
+            std::vector<ThreadRing*> rings;
+            std::vector<ThreadRing*> freeRings;
+            uint32_t nextThreadID {1};
+            std::atomic<uint64_t> resetTime {0};
+            const std::chrono::steady_clock::time_point epoch {std::chrono::steady_clock::now()};
+        };
+
+        TraceState& state() {
+            static TraceState* sState = new TraceState;
+            return *sState;
+        }
+
+        struct ThreadState {
+            ThreadRing* ring {nullptr};
+            uint32_t threadID {0};
+
+            ~ThreadState() {
+                if (ring) {
+                    TraceState &s = state();
+                    std::lock_guard<std::mutex> lock(s.mutex);
+                    s.freeRings.push_back(ring);
+                }
+            }
+        };
+
+        thread_local ThreadState tThread;
+
+        ThreadState& currentThread() {
+            ThreadState &t = tThread;
+            if (__builtin_expect(t.ring == nullptr, false)) {
+                char name[64] = "";
+                pthread_getname_np(pthread_self(), name, sizeof(name));
+                if (!name[0] && pthread_main_np())
+                    strlcpy(name, "main", sizeof(name));
+
+                TraceState &s = state();
+                std::lock_guard<std::mutex> lock(s.mutex);
+                if (!s.freeRings.empty()) {
+                    t.ring = s.freeRings.back();
+                    s.freeRings.pop_back();
+                } else {
+                    t.ring = new ThreadRing;
+                    s.rings.push_back(t.ring);
+                }
+                t.threadID = s.nextThreadID++;
+                t.ring->threadID = t.threadID;
+                t.ring->threadName = name;
+            }
+            return t;
+        }
+
+        uint64_t now() {
+            auto elapsed = std::chrono::steady_clock::now() - state().epoch;
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+        }
+
+        void appendJSONString(std::string &json, const char* str) {
+            json += '"';
+            for (const char* c = str; *c; c++) {
+                if (*c == '"' || *c == '\\') {
+                    json += '\\';
+                    json += *c;
+                } else if ((unsigned char)*c < 0x20) {
+                    char escape[8];
+                    snprintf(escape, sizeof(escape), "\\u%04x", *c);
+                    json += escape;
+                } else {
+                    json += *c;
+                }
+            }
+            json += '"';
+        }
+
+    }
+
+    void tracing::record(TraceEvent event, int64_t arg1, int64_t arg2) {
+        ThreadState &t = currentThread();
+        ThreadRing* ring = t.ring;
+        uint64_t n = ring->count.load(std::memory_order_relaxed);
+        ring->records[n % kRingSize] = {now(), t.threadID, (uint16_t)event, 0, arg1, arg2};
+        ring->count.store(n + 1, std::memory_order_release);
+    }
+
+    void setTracingEnabled(bool enabled) {
+        tracing::gEnabled.store(enabled);
+    }
+
+    void resetTrace() {
+        // Rather than clearing rings other threads are writing to, ignore older records:
+        state().resetTime.store(now());
+    }
+
+    NSData* exportChromeTrace() {
+        TraceState &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        uint64_t resetTime = s.resetTime.load();
+        int pid = getpid();
+        char buf[256];
+
+        std::string json = "{\"traceEvents\":[";
+        bool first = true;
+        auto separate = [&] {
+            if (!first)
+                json += ",\n";
+            first = false;
+        };
+
+        for (ThreadRing* ring : s.rings) {
+            separate();
+            snprintf(buf, sizeof(buf),
+                     "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%u,\"args\":{\"name\":",
+                     pid, ring->threadID);
+            json += buf;
+            appendJSONString(json, ring->threadName.c_str());
+            json += "}}";
+        }
+
+        for (ThreadRing* ring : s.rings) {
+            uint64_t end = ring->count.load(std::memory_order_acquire);
+            uint64_t start = end > kRingSize ? end - kRingSize : 0;
+            for (uint64_t i = start; i < end; i++) {
+                const TraceRecord &r = ring->records[i % kRingSize];
+                if (r.time < resetTime || r.event >= (uint16_t)TraceEvent::kCount)
+                    continue;
+                const EventInfo &info = kEventInfo[r.event];
+                separate();
+                snprintf(buf, sizeof(buf),
+                         "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":%d,\"tid\":%u",
+                         info.name, info.category, info.phase, r.time / 1000.0, pid, r.thread);
+                json += buf;
+                if (info.phase == 'i')
+                    json += ",\"s\":\"t\"";
+                if (info.arg1) {
+                    if (info.arg2)
+                        snprintf(buf, sizeof(buf), ",\"args\":{\"%s\":%lld,\"%s\":%lld}",
+                                 info.arg1, (long long)r.arg1, info.arg2, (long long)r.arg2);
+                    else
+                        snprintf(buf, sizeof(buf), ",\"args\":{\"%s\":%lld}",
+                                 info.arg1, (long long)r.arg1);
+                    json += buf;
+                }
+                json += "}";
+            }
+        }
+
+        json += "],\"displayTimeUnit\":\"ms\"}";
+        return [NSData dataWithBytes: json.data() length: json.size()];
+    }
+
+}
@@ -31,6 +31,15 @@ NS_ASSUME_NONNULL_BEGIN
 
 @end
 
+@interface CBLDocumentReplicationSummary ()
+
+- (instancetype) initWithReplicator: (CBLReplicator*)replicator
+                             isPush: (BOOL)isPush
+                      documentCount: (NSUInteger)documentCount
+                    failedDocuments: (NSArray<CBLReplicatedDocument*>*)failedDocuments;
+
+@end
+
 @interface CBLReplicatedDocument ()
 
 - (instancetype) initWithC4DocumentEnded: (const C4DocumentEnded*)docEnded;
@@ -0,0 +1,40 @@
+//
+//  CBLReplicatedRevision+Internal.h
+//  CouchbaseLite
+//
+//  Copyright (c) 2022 Couchbase, Inc All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import "CBLReplicatedRevision.h"
+#import "c4Replicator.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface CBLReplicatedRevision ()
+
+- (instancetype) initWithCollection: (CBLCollection*)collection;
+
+/** Points the object at a revision. The docID, revID and body must stay valid until -reset. */
+- (void) setDocID: (C4String)docID
+            revID: (C4String)revID
+            flags: (C4RevisionFlags)flags
+             body: (FLDict)body;
+
+/** Clears the revision so the object can be reused. */
+- (void) reset;
+
+@end
+
+NS_ASSUME_NONNULL_END
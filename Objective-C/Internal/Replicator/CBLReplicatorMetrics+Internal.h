@@ -0,0 +1,110 @@
+//
+//  CBLReplicatorMetrics+Internal.h
+//  CouchbaseLite
+//
+//  Copyright (c) 2022 Couchbase, Inc All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import "CBLReplicatorMetrics.h"
+#import "CBLReplicator.h"
+#import "fleece/slice.hh"
+#import <algorithm>
+#import <atomic>
+
+NS_ASSUME_NONNULL_BEGIN
+
+namespace cbl {
+
+    /** Counters updated by the replicator and its WebSocket as the replication progresses.
+        They're atomic, so they can be updated from any thread without taking a lock. */
+    struct ReplicatorCounters {
+        std::atomic<uint64_t> docsPushed {0}, docsPulled {0}, docErrors {0};
+        std::atomic<uint64_t> bytesSent {0}, bytesReceived {0};
+        std::atomic<uint64_t> messagesSent {0}, messagesReceived {0};
+        std::atomic<uint64_t> roundTripNanos {0};
+        std::atomic<uint64_t> filterCalls {0}, filterNanos {0};
+    };
+
+
+    /** Counts the complete WebSocket messages in a stream of frames, by parsing just the frame
+        headers and skipping the payloads. Control frames aren't counted. */
+    class WebSocketMessageCounter {
+    public:
+        /** Processes the next bytes of the stream; returns the number of messages completed. */
+        size_t count(fleece::slice bytes) {
+            size_t messages = 0;
+            auto pos = (const uint8_t*)bytes.buf, end = pos + bytes.size;
+            while (pos < end) {
+                if (_payloadRemaining > 0) {
+                    auto n = (size_t)std::min<uint64_t>(_payloadRemaining, end - pos);
+                    _payloadRemaining -= n;
+                    pos += n;
+                    continue;
+                }
+                _header[_headerLen++] = *pos++;
+                if (_headerLen < 2 || _headerLen < headerSize())
+                    continue;
+                
+                uint64_t length = _header[1] & 0x7F;
+                size_t lengthBytes = (length == 126) ? 2 : (length == 127) ? 8 : 0;
+                if (lengthBytes > 0) {
+                    length = 0;
+                    for (size_t i = 0; i < lengthBytes; ++i)
+                        length = (length << 8) | _header[2 + i];
+                }
+                bool fin = (_header[0] & 0x80) != 0;
+                bool control = (_header[0] & 0x08) != 0;
+                if (fin && !control)
+                    ++messages;
+                _payloadRemaining = length;
+                _headerLen = 0;
+            }
+            return messages;
+        }
+
+    private:
+        size_t headerSize() const {
+            uint8_t length = _header[1] & 0x7F;
+            return 2 + ((length == 126) ? 2 : (length == 127) ? 8 : 0)
+                     + ((_header[1] & 0x80) ? 4 : 0);
+        }
+
+        uint8_t _header[14];
+        size_t _headerLen {0};
+        uint64_t _payloadRemaining {0};
+    };
+
+}
+
+
+@interface CBLReplicatorMetrics ()
+
+- (instancetype) initWithCounters: (const cbl::ReplicatorCounters&)counters
+                       activeTime: (NSTimeInterval)activeTime
+                conflictsResolved: (uint64_t)conflictsResolved
+                  conflictsFailed: (uint64_t)conflictsFailed
+           conflictResolutionTime: (NSTimeInterval)conflictResolutionTime;
+
+@end
+
+
+@interface CBLReplicator (Metrics)
+
+/** The counters shared with the replicator's WebSocket. */
+@property (readonly, nonatomic) cbl::ReplicatorCounters* counters;
+
+@end
+
+NS_ASSUME_NONNULL_END
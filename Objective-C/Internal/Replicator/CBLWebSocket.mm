@@ -18,18 +18,21 @@
 //
 
 #import "CBLWebSocket.h"
+#import "CBLWebSocketDeflate.hh"
 #import "CBLHTTPLogic.h"
 #import "CBLTrustCheck.h"
 #import "CBLCoreBridge.h"
 #import "CBLStatus.h"
 #import "CBLReplicatorConfiguration.h"  // for the options constants
 #import "CBLReplicator+Internal.h"
+#import "CBLReplicatorMetrics+Internal.h"
 #import "CBLDatabase+Internal.h"
 #import "c4Socket.h"
 #import "MYURLUtils.h"
 #import "fleece/Fleece.hh"
 #import "fleece/Expert.hh"              // for AllocedDict
 #import <CommonCrypto/CommonDigest.h>
+#import <atomic>
 #import <dispatch/dispatch.h>
 #import <memory>
 #import <net/if.h>
@@ -38,6 +41,7 @@
 #import "CollectionUtils.h"
 #import "CBLURLEndpoint.h"
 #import "CBLStringBytes.h"
+#import "CBLTrace.hh"
 
 #ifdef COUCHBASE_ENTERPRISE
 #import "CBLCert.h"
@@ -49,6 +53,7 @@ extern "C" {
 }
 
 using namespace fleece;
+using namespace cbl;
 
 // Number of bytes to read from the socket at a time
 static constexpr size_t kReadBufferSize = 32 * 1024;
@@ -107,6 +112,12 @@ struct PendingWrite {
     NSString* _networkInterface;
     struct addrinfo* _addr;
     dispatch_queue_t _socketConnectQueue;
+    
+    std::unique_ptr<WebSocketDeflate> _deflate;   // Set if offering/using permessage-deflate
+    
+    ReplicatorCounters* _counters;                // The replicator's metrics counters
+    WebSocketMessageCounter _outMessages, _inMessages;
+    CFAbsoluteTime _requestTime;                  // When the WebSocket request was sent
 }
 
 @synthesize sockfd=_sockfd;
@@ -186,6 +197,7 @@ static void doDispose(C4Socket* s) {
         _db = _replicator.config.database;
 #pragma clang diagnostic pop
         _remoteURL = $castIf(CBLURLEndpoint, _replicator.config.target).url;
+        _counters = _replicator.counters;
         _readBuffer = (uint8_t*)malloc(kReadBufferSize);
         
         NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL: url];
@@ -597,11 +609,20 @@ static inline NSString* addrInfo(const struct addrinfo* addr) {
     _logic[@"Upgrade"] = @"websocket";
     _logic[@"Sec-WebSocket-Version"] = @"13";
     _logic[@"Sec-WebSocket-Key"] = nonceKey;
+    
+    if (_options[kCBLReplicatorOptionWSCompression].asBool()) {
+        _deflate.reset(new WebSocketDeflate(
+            (int)_options[kCBLReplicatorOptionWSCompressionWindowBits].asInt(),
+            (size_t)_options[kCBLReplicatorOptionWSCompressionThreshold].asUnsigned()
+                ?: WebSocketDeflate::kDefaultThreshold));
+        _logic[@"Sec-WebSocket-Extensions"] = _deflate->requestHeader();
+    }
 
     slice protocols = _options[kC4SocketOptionWSProtocols].asString();
     if (protocols)
         _logic[@"Sec-WebSocket-Protocol"] = protocols.asNSString();
 
+    _requestTime = CFAbsoluteTimeGetCurrent();
     [self writeData: _logic.HTTPRequestData completionHandler: nil];
 }
 
@@ -656,6 +677,10 @@ static inline NSString* addrInfo(const struct addrinfo* addr) {
 
 // Handles the WebSocket handshake HTTP response.
 - (void) receivedHTTPResponse: (CFHTTPMessageRef)httpResponse {
+    if (_counters)
+        _counters->roundTripNanos.store((uint64_t)((CFAbsoluteTimeGetCurrent() - _requestTime) * 1e9),
+                                        std::memory_order_relaxed);
+    
     // Post the response headers to LiteCore:
     NSDictionary *headers =  CFBridgingRelease(CFHTTPMessageCopyAllHeaderFields(httpResponse));
         
@@ -699,13 +724,30 @@ static inline NSString* addrInfo(const struct addrinfo* addr) {
     } else if (!checkHeader(headers, @"Sec-WebSocket-Accept", _expectedAcceptHeader, YES)) {
         [self closeWithCode: kWebSocketCloseProtocolError
                         reason: @"Invalid 'Sec-WebSocket-Accept' header"];
+    } else if (![self checkExtensionsHeader: headers[@"Sec-WebSocket-Extensions"]]) {
+        [self closeWithCode: kWebSocketCloseProtocolError
+                        reason: @"Invalid 'Sec-WebSocket-Extensions' header"];
     } else {
-        // TODO: Check Sec-WebSocket-Extensions for unknown extensions
         // Now I can start the WebSocket protocol:
         [self connected: headers];
     }
 }
 
+// Checks the extensions accepted by the server; only the ones offered are allowed.
+- (BOOL) checkExtensionsHeader: (nullable NSString*)extensions {
+    if (!_deflate)
+        return extensions.length == 0;
+    if (!_deflate->receivedResponseHeader(extensions))
+        return NO;
+    if (_deflate->enabled()) {
+        CBLLogInfo(WebSocket, @"%@ using permessage-deflate: %@", self, extensions);
+    } else {
+        CBLLogInfo(WebSocket, @"%@ server declined permessage-deflate", self);
+        _deflate.reset();
+    }
+    return YES;
+}
+
 // Notifies LiteCore that the WebSocket is connected.
 - (void) connected: (NSDictionary*)responseHeaders {
     CBLLogInfo(WebSocket, @"CBLWebSocket CONNECTED!");
@@ -745,24 +787,62 @@ static BOOL checkHeader(NSDictionary* headers, NSString* header, NSString* expec
 
 // callback from C4Socket
 - (void) writeAndFree: (C4SliceResult) allocatedData {
-    NSData* data = [NSData dataWithBytesNoCopy: (void*)allocatedData.buf
-                                        length: allocatedData.size
-                                  freeWhenDone: NO];
     CBLLogVerbose(WebSocket, @">>> sending %zu bytes...", allocatedData.size);
     dispatch_async(_queue, ^{
-        [self writeData: data completionHandler: ^() {
-            size_t size = allocatedData.size;
-            c4slice_free(allocatedData);
+        size_t size = allocatedData.size;
+        if (_counters)
+            _counters->messagesSent.fetch_add(_outMessages.count({allocatedData.buf, size}),
+                                              std::memory_order_relaxed);
+        void (^completed)() = ^() {
             CBLLogVerbose(WebSocket, @"    (...sent %zu bytes)", size);
             [self callC4Socket:^(C4Socket *socket) {
                 c4socket_completedWrite(socket, size);
             }];
+        };
+        
+        if (_deflate) {
+            // The compressed frames are a copy, so LiteCore's buffer can be freed right away:
+            alloc_slice frames;
+            bool ok = _deflate->encode({allocatedData.buf, allocatedData.size}, frames);
+            c4slice_free(allocatedData);
+            if (!ok) {
+                [self closeWithCode: kWebSocketCloseCantFulfill
+                             reason: @"Failed to compress WebSocket message"];
+            } else if (frames.size == 0) {
+                completed();    // Only part of a frame; it's buffered until the rest arrives
+            } else {
+                [self writeData: frames.uncopiedNSData() completionHandler: completed];
+            }
+            return;
+        }
+        
+        NSData* data = [NSData dataWithBytesNoCopy: (void*)allocatedData.buf
+                                            length: allocatedData.size
+                                      freeWhenDone: NO];
+        [self writeData: data completionHandler: ^() {
+            c4slice_free(allocatedData);
+            completed();
         }];
     });
 }
 
 // Called when WebSocket data is received (NOT necessarily an entire message.)
 - (void) receivedBytes: (const void*)bytes length: (size_t)length {
+    if (_deflate) {
+        alloc_slice frames;
+        if (!_deflate->decode({bytes, length}, frames)) {
+            [self closeWithCode: kWebSocketCloseProtocolError
+                         reason: @"Invalid compressed WebSocket frame"];
+            return;
+        }
+        if (frames.size > 0)
+            [self receivedFrames: frames];
+        return;
+    }
+    
+    if (_counters)
+        _counters->messagesReceived.fetch_add(_inMessages.count({bytes, length}),
+                                              std::memory_order_relaxed);
     self->_receivedBytesPending += length;
     CBLLogVerbose(WebSocket, @"<<< received %zu bytes [now %zu pending]",
                   (size_t)length, self->_receivedBytesPending);
@@ -771,6 +851,18 @@ static BOOL checkHeader(NSDictionary* headers, NSString* header, NSString* expec
     }];
 }
 
+// Passes decompressed frames to LiteCore; they must stay alive until c4socket_received returns.
+- (void) receivedFrames: (alloc_slice)frames {
+    if (_counters)
+        _counters->messagesReceived.fetch_add(_inMessages.count(frames), std::memory_order_relaxed);
+    self->_receivedBytesPending += frames.size;
+    CBLLogVerbose(WebSocket, @"<<< received %zu decompressed bytes [now %zu pending]",
+                  frames.size, self->_receivedBytesPending);
+    [self callC4Socket:^(C4Socket *socket) {
+        c4socket_received(socket, frames);
+    }];
+}
+
 // callback from C4Socket
 - (void) completedReceive: (size_t)byteCount {
     dispatch_async(_queue, ^{
@@ -933,6 +1025,9 @@ static BOOL checkHeader(NSDictionary* headers, NSString* header, NSString* expec
             return;
         }
         w.bytesWritten += nBytes;
+        trace(TraceEvent::WebSocketWrite, nBytes);
+        if (_counters)
+            _counters->bytesSent.fetch_add(nBytes, std::memory_order_relaxed);
         if (w.bytesWritten < w.data.length) {
             _hasSpace = false;
             return;
@@ -957,6 +1052,9 @@ static BOOL checkHeader(NSDictionary* headers, NSString* header, NSString* expec
         CBLLogVerbose(WebSocket, @"DoRead read %zu bytes", nBytes);
         if (nBytes <= 0)
             break;
+        trace(TraceEvent::WebSocketRead, nBytes);
+        if (_counters)
+            _counters->bytesReceived.fetch_add(nBytes, std::memory_order_relaxed);
         if (!_gotResponseHeaders)
             [self receivedHTTPResponseBytes: _readBuffer length: nBytes];
         else
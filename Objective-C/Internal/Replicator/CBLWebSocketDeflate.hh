@@ -0,0 +1,112 @@
+//
+//  CBLWebSocketDeflate.hh
+//  CouchbaseLite
+//
+//  Copyright (c) 2022 Couchbase, Inc All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#pragma once
+#import <Foundation/Foundation.h>
+#import "fleece/slice.hh"
+#import <vector>
+#import <zlib.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+namespace cbl {
+
+    /** Implements the WebSocket "permessage-deflate" extension (RFC 7692.)
+        LiteCore does its own WebSocket framing (kC4WebSocketClientFraming), so this works as a
+        filter between LiteCore and the socket: client frames written by LiteCore get their
+        payloads compressed before going out, and compressed frames received from the server are
+        inflated back into plain frames before being handed to LiteCore.
+        Not thread-safe; CBLWebSocket only calls it on its dispatch queue. */
+    class WebSocketDeflate {
+    public:
+        static constexpr int    kDefaultWindowBits = 15;
+        static constexpr size_t kDefaultThreshold = 256;
+        static constexpr size_t kDefaultMaxMessageSize = 16 * 1024 * 1024;
+
+        /** @param windowBits  Max LZ77 window size (9...15) for compressing outgoing messages;
+                               0 means the default.
+            @param threshold  Messages whose payload is smaller than this are sent uncompressed.
+            @param maxMessageSize  Max size of an incoming message, compressed or inflated. A
+                               bigger one fails the connection, so a small compressed message
+                               can't inflate into an unbounded amount of memory. */
+        WebSocketDeflate(int windowBits, size_t threshold,
+                         size_t maxMessageSize = kDefaultMaxMessageSize);
+        ~WebSocketDeflate();
+
+        WebSocketDeflate(const WebSocketDeflate&) =delete;
+        WebSocketDeflate& operator=(const WebSocketDeflate&) =delete;
+
+        /** The value of the "Sec-WebSocket-Extensions" request header offering the extension. */
+        NSString* requestHeader() const;
+
+        /** Processes the "Sec-WebSocket-Extensions" header of the server's handshake response.
+            Returns false if the response is invalid, in which case the connection must fail.
+            Otherwise `enabled()` tells whether the server agreed to use the extension. */
+        bool receivedResponseHeader(NSString* __nullable header);
+
+        bool enabled() const                        {return _enabled;}
+
+        /** Converts bytes written by LiteCore, which may contain partial frames, into the bytes
+            to send over the wire. Incomplete trailing frames are buffered until the next call.
+            Returns false if compression fails. */
+        bool encode(fleece::slice frames, fleece::alloc_slice &outBytes);
+
+        /** Converts bytes read from the wire into frames for LiteCore. Incomplete trailing frames
+            are buffered until the next call. Returns false if the data can't be decoded. */
+        bool decode(fleece::slice bytes, fleece::alloc_slice &outFrames);
+
+        /** Payload bytes before compression / after decompression. */
+        uint64_t messageBytesSent() const           {return _messageBytesSent;}
+        uint64_t messageBytesReceived() const       {return _messageBytesReceived;}
+
+        /** Payload bytes as sent / received on the wire. */
+        uint64_t wireBytesSent() const              {return _wireBytesSent;}
+        uint64_t wireBytesReceived() const          {return _wireBytesReceived;}
+
+    private:
+        bool compress(fleece::slice payload, std::vector<uint8_t> &output);
+        bool decompress(fleece::slice payload, std::vector<uint8_t> &output);
+
+        int _windowBits;                            // Configured max window for compression
+        size_t _threshold;                          // Min payload size to compress
+        size_t _maxMessageSize;                     // Max incoming message size
+        bool _enabled {false};                      // Negotiated with the server?
+        bool _clientNoContextTakeover {false};      // Reset compressor after each message?
+        bool _serverNoContextTakeover {false};      // Reset decompressor after each message?
+        bool _canCompress {false};                  // False if server's window is too small
+
+        z_stream _deflater {};
+        z_stream _inflater {};
+        bool _deflaterInitialized {false};
+        bool _inflaterInitialized {false};
+
+        std::vector<uint8_t> _outBuffer;            // Unprocessed bytes from LiteCore
+
+        std::vector<uint8_t> _inBuffer;             // Unprocessed bytes from the wire
+        std::vector<uint8_t> _inMessage;            // Compressed payload of a fragmented message
+        uint8_t _inOpcode {0};                      // Opcode of the current incoming message
+        bool _inCompressed {false};                 // Is the current incoming message compressed?
+
+        uint64_t _messageBytesSent {0}, _messageBytesReceived {0};
+        uint64_t _wireBytesSent {0}, _wireBytesReceived {0};
+    };
+
+}
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,372 @@
+//
+//  CBLWebSocketDeflate.mm
+//  CouchbaseLite
+//
+//  Copyright (c) 2022 Couchbase, Inc All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import "CBLWebSocketDeflate.hh"
+#import <algorithm>
+
+using namespace fleece;
+
+namespace cbl {
+
+    // WebSocket frame header bits (RFC 6455, section 5.2):
+    static constexpr uint8_t kFinBit    = 0x80;
+    static constexpr uint8_t kRSV1Bit   = 0x40;         // "Per-Message Compressed" bit
+    static constexpr uint8_t kOpcodeMask = 0x0F;
+    static constexpr uint8_t kMaskBit   = 0x80;
+
+    static constexpr uint8_t kOpContinuation = 0x0;
+    static constexpr uint8_t kOpText    = 0x1;
+    static constexpr uint8_t kOpBinary  = 0x2;
+
+    // Every message compressed with Z_SYNC_FLUSH ends with these bytes, which aren't sent
+    // (RFC 7692, section 7.2.1):
+    static constexpr uint8_t kDeflateTrailer[4] = {0x00, 0x00, 0xFF, 0xFF};
+
+    static constexpr size_t kZlibChunkSize = 16 * 1024;
+
+    struct FrameHeader {
+        bool fin, rsv1, masked;
+        uint8_t opcode;
+        uint8_t mask[4];
+        uint64_t payloadLength;
+        size_t headerLength;
+
+        bool isControl() const      {return (opcode & 0x8) != 0;}
+        size_t frameLength() const  {return headerLength + (size_t)payloadLength;}
+    };
+
+
+    // Parses a frame header. Returns false if there aren't enough bytes for a complete header.
+    static bool parseFrameHeader(slice data, FrameHeader &h) {
+        if (data.size < 2)
+            return false;
+        auto b = (const uint8_t*)data.buf;
+        h.fin = (b[0] & kFinBit) != 0;
+        h.rsv1 = (b[0] & kRSV1Bit) != 0;
+        h.opcode = b[0] & kOpcodeMask;
+        h.masked = (b[1] & kMaskBit) != 0;
+        uint64_t length = b[1] & 0x7F;
+        size_t pos = 2;
+        if (length == 126) {
+            if (data.size < 4)
+                return false;
+            length = (uint64_t(b[2]) << 8) | b[3];
+            pos = 4;
+        } else if (length == 127) {
+            if (data.size < 10)
+                return false;
+            length = 0;
+            for (int i = 0; i < 8; ++i)
+                length = (length << 8) | b[2 + i];
+            pos = 10;
+        }
+        if (h.masked) {
+            if (data.size < pos + 4)
+                return false;
+            memcpy(h.mask, b + pos, 4);
+            pos += 4;
+        }
+        h.payloadLength = length;
+        h.headerLength = pos;
+        return true;
+    }
+
+
+    static void writeFrameHeader(std::vector<uint8_t> &out, bool fin, bool rsv1, uint8_t opcode,
+                                 const uint8_t* __nullable mask, uint64_t length)
+    {
+        out.push_back((fin ? kFinBit : 0) | (rsv1 ? kRSV1Bit : 0) | opcode);
+        uint8_t maskBit = mask ? kMaskBit : 0;
+        if (length < 126) {
+            out.push_back(maskBit | uint8_t(length));
+        } else if (length <= 0xFFFF) {
+            out.push_back(maskBit | 126);
+            out.push_back(uint8_t(length >> 8));
+            out.push_back(uint8_t(length));
+        } else {
+            out.push_back(maskBit | 127);
+            for (int shift = 56; shift >= 0; shift -= 8)
+                out.push_back(uint8_t(length >> shift));
+        }
+        if (mask)
+            out.insert(out.end(), mask, mask + 4);
+    }
+
+
+    static void applyMask(uint8_t *bytes, size_t length, const uint8_t mask[4]) {
+        for (size_t i = 0; i < length; ++i)
+            bytes[i] ^= mask[i & 3];
+    }
+
+
+    WebSocketDeflate::WebSocketDeflate(int windowBits, size_t threshold, size_t maxMessageSize)
+    :_windowBits(windowBits > 0 ? std::min(std::max(windowBits, 9), 15) : kDefaultWindowBits)
+    ,_threshold(std::max(threshold, size_t(1)))
+    ,_maxMessageSize(maxMessageSize)
+    { }
+
+
+    WebSocketDeflate::~WebSocketDeflate() {
+        if (_deflaterInitialized)
+            deflateEnd(&_deflater);
+        if (_inflaterInitialized)
+            inflateEnd(&_inflater);
+    }
+
+
+#pragma mark - NEGOTIATION:
+
+
+    NSString* WebSocketDeflate::requestHeader() const {
+        // Offering "client_max_window_bits" without a value lets the server limit our window:
+        return @"permessage-deflate; client_max_window_bits";
+    }
+
+
+    bool WebSocketDeflate::receivedResponseHeader(NSString* __nullable header) {
+        _enabled = false;
+        if (header.length == 0)
+            return true;            // Server declined the extension
+
+        NSCharacterSet* whitespace = [NSCharacterSet whitespaceCharacterSet];
+        NSArray* params = [header componentsSeparatedByString: @";"];
+        NSString* name = [params[0] stringByTrimmingCharactersInSet: whitespace];
+        if ([name caseInsensitiveCompare: @"permessage-deflate"] != 0)
+            return false;           // Server accepted an extension we didn't offer
+
+        int clientWindowBits = _windowBits;
+        for (NSUInteger i = 1; i < params.count; ++i) {
+            NSArray* kv = [params[i] componentsSeparatedByString: @"="];
+            NSString* key = [kv[0] stringByTrimmingCharactersInSet: whitespace];
+            NSString* value = kv.count > 1 ? [kv[1] stringByTrimmingCharactersInSet: whitespace]
+                                           : nil;
+            value = [value stringByTrimmingCharactersInSet:
+                        [NSCharacterSet characterSetWithCharactersInString: @"\""]];
+            if ([key isEqualToString: @"client_no_context_takeover"]) {
+                _clientNoContextTakeover = true;
+            } else if ([key isEqualToString: @"server_no_context_takeover"]) {
+                _serverNoContextTakeover = true;
+            } else if ([key isEqualToString: @"client_max_window_bits"]) {
+                int bits = value.intValue;
+                if (bits < 8 || bits > 15)
+                    return false;
+                clientWindowBits = std::min(clientWindowBits, bits);
+            } else if ([key isEqualToString: @"server_max_window_bits"]) {
+                // The inflater always uses the max window, which can decode any smaller one.
+                int bits = value.intValue;
+                if (bits < 8 || bits > 15)
+                    return false;
+            } else {
+                return false;       // Unknown parameter
+            }
+        }
+
+        // zlib's raw deflate can't produce an 8-bit window; in that case nothing gets compressed,
+        // which is allowed since compressing any given message is optional:
+        _canCompress = (clientWindowBits >= 9);
+        if (_canCompress) {
+            if (deflateInit2(&_deflater, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -clientWindowBits,
+                             8, Z_DEFAULT_STRATEGY) != Z_OK)
+                return false;
+            _deflaterInitialized = true;
+        }
+        if (inflateInit2(&_inflater, -15) != Z_OK)
+            return false;
+        _inflaterInitialized = true;
+        _enabled = true;
+        return true;
+    }
+
+
+#pragma mark - COMPRESSION:
+
+
+    bool WebSocketDeflate::compress(slice payload, std::vector<uint8_t> &output) {
+        size_t start = output.size();
+        _deflater.next_in = (Bytef*)payload.buf;
+        _deflater.avail_in = (uInt)payload.size;
+        do {
+            size_t pos = output.size();
+            output.resize(pos + kZlibChunkSize);
+            _deflater.next_out = &output[pos];
+            _deflater.avail_out = (uInt)kZlibChunkSize;
+            int rc = ::deflate(&_deflater, Z_SYNC_FLUSH);
+            output.resize(pos + kZlibChunkSize - _deflater.avail_out);
+            if (rc != Z_OK && rc != Z_BUF_ERROR)
+                return false;
+        } while (_deflater.avail_out == 0);
+
+        // Strip the sync-flush trailer:
+        if (output.size() - start >= 4
+                && memcmp(&output[output.size() - 4], kDeflateTrailer, 4) == 0)
+            output.resize(output.size() - 4);
+
+        if (_clientNoContextTakeover)
+            deflateReset(&_deflater);
+        return true;
+    }
+
+
+    bool WebSocketDeflate::decompress(slice payload, std::vector<uint8_t> &output) {
+        std::vector<uint8_t> input((const uint8_t*)payload.buf,
+                                   (const uint8_t*)payload.buf + payload.size);
+        input.insert(input.end(), kDeflateTrailer, kDeflateTrailer + 4);
+        _inflater.next_in = input.data();
+        _inflater.avail_in = (uInt)input.size();
+        for (;;) {
+            size_t pos = output.size();
+            output.resize(pos + kZlibChunkSize);
+            _inflater.next_out = &output[pos];
+            _inflater.avail_out = (uInt)kZlibChunkSize;
+            int rc = ::inflate(&_inflater, Z_SYNC_FLUSH);
+            output.resize(pos + kZlibChunkSize - _inflater.avail_out);
+            if (output.size() > _maxMessageSize)
+                return false;       // Decompression bomb, or just too big
+            if (rc == Z_STREAM_END) {
+                // Peer ended the deflate stream (BFINAL); the next message starts a new one.
+                inflateReset(&_inflater);
+                break;
+            } else if (rc == Z_BUF_ERROR) {
+                break;              // No more progress possible; all input consumed
+            } else if (rc != Z_OK) {
+                return false;
+            } else if (_inflater.avail_in == 0 && _inflater.avail_out > 0) {
+                break;
+            }
+        }
+
+        if (_serverNoContextTakeover)
+            inflateReset(&_inflater);
+        return true;
+    }
+
+
+#pragma mark - FRAMING:
+
+
+    bool WebSocketDeflate::encode(slice frames, alloc_slice &outBytes) {
+        _outBuffer.insert(_outBuffer.end(),
+                          (const uint8_t*)frames.buf, (const uint8_t*)frames.buf + frames.size);
+        std::vector<uint8_t> output;
+        output.reserve(_outBuffer.size());
+
+        size_t pos = 0;
+        FrameHeader h;
+        while (parseFrameHeader(slice(_outBuffer.data() + pos, _outBuffer.size() - pos), h)
+                    && _outBuffer.size() - pos >= h.frameLength()) {
+            const uint8_t* frame = _outBuffer.data() + pos;
+            slice payload(frame + h.headerLength, (size_t)h.payloadLength);
+            bool dataFrame = (h.opcode == kOpText || h.opcode == kOpBinary);
+            _messageBytesSent += payload.size;
+
+            // Only compress unfragmented messages; RSV1 would have to be set on the first
+            // fragment, before knowing how big the message is:
+            if (_enabled && _canCompress && dataFrame && h.fin && !h.rsv1
+                    && payload.size >= _threshold) {
+                std::vector<uint8_t> plain((const uint8_t*)payload.buf,
+                                           (const uint8_t*)payload.buf + payload.size);
+                if (h.masked)
+                    applyMask(plain.data(), plain.size(), h.mask);
+                std::vector<uint8_t> compressed;
+                if (!compress(slice(plain.data(), plain.size()), compressed))
+                    return false;
+                if (h.masked)
+                    applyMask(compressed.data(), compressed.size(), h.mask);
+                writeFrameHeader(output, true, true, h.opcode, (h.masked ? h.mask : nullptr),
+                                 compressed.size());
+                output.insert(output.end(), compressed.begin(), compressed.end());
+                _wireBytesSent += compressed.size();
+            } else {
+                output.insert(output.end(), frame, frame + h.frameLength());
+                _wireBytesSent += payload.size;
+            }
+
+            pos += h.frameLength();
+        }
+        _outBuffer.erase(_outBuffer.begin(), _outBuffer.begin() + pos);
+
+        outBytes = output.empty() ? alloc_slice() : alloc_slice(output.data(), output.size());
+        return true;
+    }
+
+
+    bool WebSocketDeflate::decode(slice bytes, alloc_slice &outFrames) {
+        _inBuffer.insert(_inBuffer.end(),
+                         (const uint8_t*)bytes.buf, (const uint8_t*)bytes.buf + bytes.size);
+        std::vector<uint8_t> output;
+        output.reserve(_inBuffer.size());
+
+        size_t pos = 0;
+        FrameHeader h;
+        while (parseFrameHeader(slice(_inBuffer.data() + pos, _inBuffer.size() - pos), h)
+                    && _inBuffer.size() - pos >= h.frameLength()) {
+            const uint8_t* frame = _inBuffer.data() + pos;
+            slice payload(frame + h.headerLength, (size_t)h.payloadLength);
+            _wireBytesReceived += payload.size;
+            pos += h.frameLength();
+
+            if (h.isControl()) {
+                // Control frames are never compressed and may be interleaved with fragments:
+                if (h.rsv1)
+                    return false;
+                output.insert(output.end(), frame, frame + h.frameLength());
+                _messageBytesReceived += payload.size;
+                continue;
+            }
+
+            if (h.opcode != kOpContinuation) {
+                if (h.rsv1 && !_enabled)
+                    return false;
+                _inOpcode = h.opcode;
+                _inCompressed = h.rsv1;
+                _inMessage.clear();
+            } else if (h.rsv1) {
+                return false;       // RSV1 is only allowed on the first fragment
+            }
+
+            if (!_inCompressed) {
+                output.insert(output.end(), frame, frame + h.frameLength());
+                _messageBytesReceived += payload.size;
+                continue;
+            }
+
+            if (h.masked)
+                return false;       // Servers must not mask frames (RFC 6455, section 5.1)
+            if (_inMessage.size() + payload.size > _maxMessageSize)
+                return false;
+            _inMessage.insert(_inMessage.end(), (const uint8_t*)payload.buf,
+                              (const uint8_t*)payload.buf + payload.size);
+            if (h.fin) {
+                std::vector<uint8_t> inflated;
+                if (!decompress(slice(_inMessage.data(), _inMessage.size()), inflated))
+                    return false;
+                writeFrameHeader(output, true, false, _inOpcode, nullptr, inflated.size());
+                output.insert(output.end(), inflated.begin(), inflated.end());
+                _messageBytesReceived += inflated.size();
+                _inMessage.clear();
+                _inCompressed = false;
+            }
+        }
+        _inBuffer.erase(_inBuffer.begin(), _inBuffer.begin() + pos);
+
+        outFrames = output.empty() ? alloc_slice() : alloc_slice(output.data(), output.size());
+        return true;
+    }
+
+}
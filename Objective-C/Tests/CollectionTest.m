@@ -1098,4 +1098,158 @@
     AssertEqual(error.code, CBLErrorNotOpen);
 }
 
+#pragma mark - Get Documents
+
+- (void) testDocumentMetadataWithID {
+    NSError* error = nil;
+    CBLCollection* col = [self.db createCollectionWithName: @"colA" scope: nil error: &error];
+    AssertNotNil(col);
+    [self createDocNumbered: col start: 0 num: 10];
+    
+    CBLDocument* full = [col documentWithID: @"doc3" error: &error];
+    CBLDocument* doc = [col documentMetadataWithID: @"doc3" error: &error];
+    AssertNotNil(doc);
+    AssertNil(error);
+    AssertEqualObjects(doc.id, @"doc3");
+    AssertEqualObjects(doc.revisionID, full.revisionID);
+    AssertEqual(doc.sequence, full.sequence);
+    
+    // The properties are loaded on first access:
+    AssertEqual([doc integerForKey: @"number1"], 3);
+    AssertEqual([doc integerForKey: @"number2"], 7);
+    AssertEqualObjects([doc toDictionary], [full toDictionary]);
+    AssertEqualObjects(doc, full);
+    
+    // A mutable copy gets the properties too, and can be saved:
+    doc = [col documentMetadataWithID: @"doc4" error: &error];
+    CBLMutableDocument* mdoc = [doc toMutable];
+    AssertEqual([mdoc integerForKey: @"number1"], 4);
+    [mdoc setInteger: 44 forKey: @"number1"];
+    Assert([col saveDocument: mdoc error: &error], @"Failed to save: %@", error);
+    AssertEqual([[col documentWithID: @"doc4" error: &error] integerForKey: @"number1"], 44);
+    AssertEqual([[col documentWithID: @"doc4" error: &error] integerForKey: @"number2"], 6);
+    
+    // Purging a document whose properties haven't been loaded keeps them:
+    doc = [col documentMetadataWithID: @"doc5" error: &error];
+    Assert([col purgeDocument: doc error: &error], @"Failed to purge: %@", error);
+    AssertEqual([doc integerForKey: @"number1"], 5);
+    
+    // Missing and deleted documents:
+    AssertNil([col documentMetadataWithID: @"doc5" error: &error]);
+    Assert([col deleteDocument: [col documentWithID: @"doc6" error: nil] error: &error]);
+    AssertNil([col documentMetadataWithID: @"doc6" error: &error]);
+}
+
+- (void) testDocumentsWithIDs {
+    NSError* error = nil;
+    CBLCollection* col = [self.db createCollectionWithName: @"colA" scope: nil error: &error];
+    AssertNotNil(col);
+    [self createDocNumbered: col start: 0 num: 10];
+    Assert([col deleteDocument: [col documentWithID: @"doc2" error: nil] error: &error]);
+    
+    NSArray* ids = @[@"doc7", @"doc2", @"doc0", @"missing", @"doc9", @"doc0"];
+    NSArray<CBLDocument*>* docs = [col documentsWithIDs: ids error: &error];
+    AssertNotNil(docs);
+    AssertNil(error);
+    AssertEqual(docs.count, 4u);
+    AssertEqualObjects(docs[0].id, @"doc7");
+    AssertEqualObjects(docs[1].id, @"doc0");
+    AssertEqualObjects(docs[2].id, @"doc9");
+    AssertEqualObjects(docs[3].id, @"doc0");
+    Assert(docs[1] == docs[3]);
+    AssertEqual([docs[0] integerForKey: @"number1"], 7);
+    AssertEqual([docs[2] integerForKey: @"number2"], 1);
+    AssertEqualObjects(docs[1], [col documentWithID: @"doc0" error: nil]);
+    
+    docs = [col documentsWithIDs: @[] error: &error];
+    AssertEqual(docs.count, 0u);
+    
+    // The database must still be writable after the batch:
+    [self createDocNumbered: col start: 10 num: 1];
+    AssertEqual(col.count, 10u);
+    
+    [self.db close: &error];
+    [self expectError: CBLErrorDomain code: CBLErrorNotOpen in: ^BOOL(NSError** err) {
+        return [col documentsWithIDs: ids error: err] != nil;
+    }];
+}
+
+#pragma mark - Batch Purge & Expiration
+
+- (void) testPurgeDocumentsWithIDs {
+    NSError* error = nil;
+    CBLCollection* col = [self.db createCollectionWithName: @"colA" scope: nil error: &error];
+    AssertNotNil(col);
+    [self createDocNumbered: col start: 0 num: 10];
+    
+    NSSet* purged = [col purgeDocumentsWithIDs: @[@"doc1", @"doc3", @"missing", @"doc5"]
+                                         error: &error];
+    AssertNil(error);
+    AssertEqualObjects(purged, ([NSSet setWithObjects: @"doc1", @"doc3", @"doc5", nil]));
+    AssertEqual(col.count, 7u);
+    AssertNil([col documentWithID: @"doc3" error: nil]);
+    AssertNotNil([col documentWithID: @"doc4" error: nil]);
+    
+    purged = [col purgeDocumentsWithIDs: @[@"doc1"] error: &error];
+    AssertNil(error);
+    AssertEqual(purged.count, 0u);
+    
+    [self.db close: &error];
+    [self expectError: CBLErrorDomain code: CBLErrorNotOpen in: ^BOOL(NSError** err) {
+        return [col purgeDocumentsWithIDs: @[@"doc2"] error: err] != nil;
+    }];
+}
+
+- (void) testPurgeDocumentsWhere {
+    NSError* error = nil;
+    CBLCollection* colA = [self.db createCollectionWithName: @"colA" scope: nil error: &error];
+    AssertNotNil(colA);
+    CBLCollection* colB = [self.db createCollectionWithName: @"colB" scope: nil error: &error];
+    AssertNotNil(colB);
+    [self createDocNumbered: colA start: 0 num: 10];
+    [self createDocNumbered: colB start: 0 num: 10];
+    
+    CBLQueryExpression* number1 = [CBLQueryExpression property: @"number1"];
+    NSSet* purged = [colA purgeDocumentsWhere: [number1 greaterThanOrEqualTo:
+                                                [CBLQueryExpression integer: 6]]
+                                        error: &error];
+    AssertNil(error);
+    AssertEqualObjects(purged, ([NSSet setWithObjects: @"doc6", @"doc7", @"doc8", @"doc9", nil]));
+    AssertEqual(colA.count, 6u);
+    
+    // Documents with the same IDs in another collection are left alone:
+    AssertEqual(colB.count, 10u);
+    AssertNotNil([colB documentWithID: @"doc6" error: &error]);
+    
+    // Nothing matches:
+    purged = [colA purgeDocumentsWhere: [number1 greaterThan: [CBLQueryExpression integer: 100]]
+                                 error: &error];
+    AssertNil(error);
+    AssertEqual(purged.count, 0u);
+    AssertEqual(colA.count, 6u);
+}
+
+- (void) testSetDocumentExpirationForIDs {
+    NSError* error = nil;
+    CBLCollection* col = [self.db createCollectionWithName: @"colA" scope: nil error: &error];
+    AssertNotNil(col);
+    [self createDocNumbered: col start: 0 num: 10];
+    
+    NSDate* date = [NSDate dateWithTimeIntervalSinceNow: 3600];
+    NSSet* updated = [col setDocumentExpirationForIDs: @[@"doc2", @"missing", @"doc4"]
+                                           expiration: date error: &error];
+    AssertNil(error);
+    AssertEqualObjects(updated, ([NSSet setWithObjects: @"doc2", @"doc4", nil]));
+    NSDate* expiration = [col getDocumentExpirationWithID: @"doc4" error: &error];
+    AssertNotNil(expiration);
+    Assert(ABS(expiration.timeIntervalSince1970 - date.timeIntervalSince1970) < 1.0);
+    AssertNil([col getDocumentExpirationWithID: @"doc3" error: &error]);
+    
+    // A nil date clears the expiration:
+    updated = [col setDocumentExpirationForIDs: @[@"doc2", @"doc4"] expiration: nil error: &error];
+    AssertEqual(updated.count, 2u);
+    AssertNil([col getDocumentExpirationWithID: @"doc2" error: &error]);
+    AssertNil([col getDocumentExpirationWithID: @"doc4" error: &error]);
+}
+
 @end
@@ -35,15 +35,21 @@
 }
 
 - (NSArray*) lines {
-    return _lines;
+    @synchronized (self) {
+        return [_lines copy];
+    }
 }
 
 - (void) reset {
-    [_lines removeAllObjects];
+    @synchronized (self) {
+        [_lines removeAllObjects];
+    }
 }
 
 - (void)logWithLevel: (CBLLogLevel)level domain: (CBLLogDomain)domain message: (NSString*)message {
-    [_lines addObject: message];        
+    @synchronized (self) {
+        [_lines addObject: message];
+    }
 }
 
 @end
@@ -156,6 +156,148 @@
     }];
 }
 
+- (void) testTuningConfiguration {
+    CBLDatabaseConfiguration* config = [[CBLDatabaseConfiguration alloc] init];
+    AssertEqual(config.pageCacheSize, 0u);
+    AssertEqual(config.mmapSize, 0u);
+    AssertEqual(config.walAutoCheckpoint, 0u);
+    AssertFalse(config.fullSync);
+    
+    config.directory = self.directory;
+    config.pageCacheSize = 16 * 1024 * 1024;
+    config.mmapSize = 128 * 1024 * 1024;
+    config.walAutoCheckpoint = 10000;
+    config.fullSync = YES;
+    
+    CBLDatabaseConfiguration* copy = [[CBLDatabaseConfiguration alloc] initWithConfig: config];
+    AssertEqual(copy.pageCacheSize, 16u * 1024 * 1024);
+    AssertEqual(copy.mmapSize, 128u * 1024 * 1024);
+    AssertEqual(copy.walAutoCheckpoint, 10000u);
+    Assert(copy.fullSync);
+    
+    NSError* error;
+    CBLDatabase* db = [[CBLDatabase alloc] initWithName: @"tuned" config: config error: &error];
+    AssertNotNil(db, @"Couldn't open db: %@", error);
+    AssertEqual(db.config.walAutoCheckpoint, 10000u);
+    
+    [self expectException: @"NSInternalInconsistencyException" in: ^{
+        db.config.fullSync = NO;
+    }];
+    
+    CBLMutableDocument* doc = [self createDocument: @"doc1"];
+    [doc setString: @"bar" forKey: @"foo"];
+    Assert([db saveDocument: doc error: &error], @"Couldn't save doc: %@", error);
+    AssertEqual(db.count, 1u);
+    
+    [self deleteDatabase: db];
+}
+
+#pragma mark - Read-Only Database
+
+- (CBLDatabase*) openReadOnlyDBNamed: (NSString*)name error: (NSError**)error {
+    CBLDatabaseConfiguration* config = [[CBLDatabaseConfiguration alloc] init];
+    config.directory = self.directory;
+    config.readOnly = YES;
+    return [[CBLDatabase alloc] initWithName: name config: config error: error];
+}
+
+- (void) testReadOnlyOpenMissingDatabase {
+    NSError* error;
+    CBLDatabase* db = [self openReadOnlyDBNamed: @"nonexistent" error: &error];
+    AssertNil(db);
+    AssertEqualObjects(error.domain, CBLErrorDomain);
+    AssertEqual(error.code, CBLErrorNotFound);
+}
+
+- (void) testReadOnlyDatabaseIsNotWriteable {
+    [self generateDocumentWithID: @"doc1"];
+    
+    NSError* error;
+    CBLDatabase* reader = [self openReadOnlyDBNamed: self.db.name error: &error];
+    AssertNotNil(reader, @"Couldn't open db: %@", error);
+    Assert(reader.config.readOnly);
+    AssertEqual(reader.count, 1u);
+    
+    CBLMutableDocument* doc = [self createDocument: @"doc2"];
+    [self expectError: CBLErrorDomain code: CBLErrorNotWriteable in: ^BOOL(NSError** err) {
+        return [reader saveDocument: doc error: err];
+    }];
+    
+    // Listeners can be added but are never called:
+    id token = [reader addChangeListener: ^(CBLDatabaseChange* change) {
+        XCTFail(@"Unexpected change notification");
+    }];
+    [self generateDocumentWithID: @"doc3"];
+    [reader removeChangeListenerWithToken: token];
+    
+    Assert([reader close: &error], @"Couldn't close db: %@", error);
+}
+
+// Separate database instances have their own SQLite connections, so as far as SQLite is
+// concerned they behave like separate processes.
+- (void) testReadOnlySeesCommittedChanges {
+    [self generateDocumentWithID: @"doc1"];
+    
+    NSError* error;
+    CBLDatabase* reader = [self openReadOnlyDBNamed: self.db.name error: &error];
+    AssertNotNil(reader, @"Couldn't open db: %@", error);
+    
+    Assert([self.db inBatch: &error usingBlock: ^{
+        [self generateDocumentWithID: @"doc2"];
+        // Not committed yet:
+        AssertNil([reader documentWithID: @"doc2"]);
+        AssertEqual(reader.count, 1u);
+    }], @"Batch failed: %@", error);
+    
+    AssertNotNil([reader documentWithID: @"doc2"]);
+    AssertEqual(reader.count, 2u);
+    
+    [self.db purgeDocumentWithID: @"doc1" error: &error];
+    AssertNil([reader documentWithID: @"doc1"]);
+    
+    Assert([reader close: &error], @"Couldn't close db: %@", error);
+}
+
+- (void) testConcurrentReadOnlyReaders {
+    const NSUInteger kNumReaders = 4, kNumDocs = 100;
+    [self generateDocumentWithID: @"doc0"];
+    
+    NSMutableArray<CBLDatabase*>* readers = [NSMutableArray array];
+    for (NSUInteger i = 0; i < kNumReaders; i++) {
+        NSError* error;
+        CBLDatabase* reader = [self openReadOnlyDBNamed: self.db.name error: &error];
+        AssertNotNil(reader, @"Couldn't open db: %@", error);
+        [readers addObject: reader];
+    }
+    
+    // Readers keep reading while the writer writes; counts can only grow:
+    // Each reader stops once it takes one of the signals sent when the writer is done:
+    dispatch_group_t group = dispatch_group_create();
+    dispatch_semaphore_t done = dispatch_semaphore_create(0);
+    for (CBLDatabase* reader in readers) {
+        dispatch_group_async(group, dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0), ^{
+            uint64_t lastCount = 0;
+            while (dispatch_semaphore_wait(done, DISPATCH_TIME_NOW) != 0) {
+                uint64_t count = reader.count;
+                Assert(count >= lastCount);
+                lastCount = count;
+                AssertNotNil([reader documentWithID: @"doc0"]);
+            }
+        });
+    }
+    for (NSUInteger i = 1; i <= kNumDocs; i++)
+        [self generateDocumentWithID: [NSString stringWithFormat: @"doc%lu", (unsigned long)i]];
+    for (NSUInteger i = 0; i < kNumReaders; i++)
+        dispatch_semaphore_signal(done);
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+    
+    for (CBLDatabase* reader in readers) {
+        AssertEqual(reader.count, kNumDocs + 1);
+        NSError* error;
+        Assert([reader close: &error], @"Couldn't close db: %@", error);
+    }
+}
+
 #pragma mark - Create Database
 
 - (void) testCreate {
@@ -170,6 +312,22 @@
     [self deleteDatabase: db];
 }
 
+- (void) testOpenTimings {
+    NSError* error;
+    CBLDatabase* db = [self openDBNamed: @"db" error: &error];
+    AssertNotNil(db, @"Couldn't open db: %@", error);
+    
+    CBLDatabaseOpenTimings timings = db.openTimings;
+    Log(@"Opened in %.3f ms: log setup %.3f, directory %.3f, c4db_openNamed %.3f, "
+        "default collection %.3f", timings.total * 1000.0, timings.logSetup * 1000.0,
+        timings.directory * 1000.0, timings.c4Open * 1000.0, timings.defaultCollection * 1000.0);
+    Assert(timings.c4Open > 0.0);
+    Assert(timings.total >= timings.logSetup + timings.directory + timings.c4Open
+                            + timings.defaultCollection);
+    
+    [self deleteDatabase: db];
+}
+
 #if TARGET_OS_IPHONE
 - (void) testCreateWithDefaultConfiguration {
     // create db with default configuration
@@ -2037,6 +2195,135 @@
     AssertEqual(atts.count, 0u);
 }
 
+- (void) testIncrementalMaintenanceCompact {
+    // Create and then delete enough data to leave free pages behind:
+    NSError* error;
+    NSString* padding = [@"" stringByPaddingToLength: 4000 withString: @"x" startingAtIndex: 0];
+    Assert([_db inBatch: &error usingBlock: ^{
+        for (NSUInteger i = 0; i < 500; i++) {
+            CBLMutableDocument* doc = [self createDocument: $sprintf(@"doc-%lu", (unsigned long)i)];
+            [doc setString: padding forKey: @"padding"];
+            [self saveDocument: doc];
+        }
+    }], @"Batch failed: %@", error);
+    Assert([_db inBatch: &error usingBlock: ^{
+        for (NSUInteger i = 0; i < 500; i++)
+            [_db purgeDocumentWithID: $sprintf(@"doc-%lu", (unsigned long)i) error: nil];
+    }], @"Batch failed: %@", error);
+    
+    NSMutableArray<NSNumber*>* progressValues = [NSMutableArray array];
+    XCTestExpectation* done = [self expectationWithDescription: @"maintenance done"];
+    CBLMaintenanceTask* task =
+        [_db performIncrementalMaintenance: kCBLMaintenanceTypeCompact
+                                 timeSlice: 0.001
+                                     queue: nil
+                                  progress: ^(double progress) {
+                                      [progressValues addObject: @(progress)];
+                                  }
+                                completion: ^(NSError* err) {
+                                    AssertNil(err);
+                                    [done fulfill];
+                                }];
+    AssertEqual(task.type, kCBLMaintenanceTypeCompact);
+    
+    // The database stays usable while the task runs:
+    [self generateDocumentWithID: @"doc-new"];
+    
+    [self waitForExpectations: @[done] timeout: 10.0];
+    XCTAssertEqualWithAccuracy(task.progress, 1.0, 0.0001);
+    for (NSUInteger i = 1; i < progressValues.count; i++)
+        Assert(progressValues[i].doubleValue >= progressValues[i - 1].doubleValue);
+    AssertEqual(_db.count, 1u);
+}
+
+- (void) testIncrementalMaintenanceFullOptimize {
+    [self createDocs: 20];
+    CBLValueIndex* index = [CBLIndexBuilder valueIndexWithItems:
+                            @[[CBLValueIndexItem property: @"key"]]];
+    NSError* error;
+    Assert([_db createIndex: index withName: @"KeyIndex" error: &error], @"Error: %@", error);
+    
+    XCTestExpectation* done = [self expectationWithDescription: @"maintenance done"];
+    CBLMaintenanceTask* task =
+        [_db performIncrementalMaintenance: kCBLMaintenanceTypeFullOptimize
+                                 timeSlice: 0
+                                     queue: nil
+                                  progress: nil
+                                completion: ^(NSError* err) {
+                                    AssertNil(err);
+                                    [done fulfill];
+                                }];
+    [self waitForExpectations: @[done] timeout: 10.0];
+    XCTAssertEqualWithAccuracy(task.progress, 1.0, 0.0001);
+}
+
+- (void) testIncrementalMaintenanceUnsupportedTypes {
+    [self createDocs: 20];
+    
+    // These can only run in a single step, which would hold the lock for as long as they take:
+    for (NSNumber* type in @[@(kCBLMaintenanceTypeReindex), @(kCBLMaintenanceTypeOptimize),
+                             @(kCBLMaintenanceTypeIntegrityCheck)]) {
+        XCTestExpectation* done = [self expectationWithDescription: @"maintenance done"];
+        [_db performIncrementalMaintenance: (CBLMaintenanceType)type.unsignedIntValue
+                                 timeSlice: 0
+                                     queue: nil
+                                  progress: nil
+                                completion: ^(NSError* err) {
+                                    AssertEqualObjects(err.domain, CBLErrorDomain);
+                                    AssertEqual(err.code, CBLErrorUnsupported);
+                                    [done fulfill];
+                                }];
+        [self waitForExpectations: @[done] timeout: 10.0];
+    }
+    
+    // They still work synchronously:
+    NSError* error;
+    Assert([_db performMaintenance: kCBLMaintenanceTypeOptimize error: &error],
+           @"Error: %@", error);
+}
+
+- (void) testIncrementalMaintenanceCancel {
+    XCTestExpectation* done = [self expectationWithDescription: @"maintenance done"];
+    CBLMaintenanceTask* task;
+    // Keep the task from running its first step until it's been cancelled:
+    @synchronized (_db.mutex) {
+        task = [_db performIncrementalMaintenance: kCBLMaintenanceTypeFullOptimize
+                                        timeSlice: 0
+                                            queue: nil
+                                         progress: nil
+                                       completion: ^(NSError* err) {
+                                           AssertEqualObjects(err.domain, NSCocoaErrorDomain);
+                                           AssertEqual(err.code, NSUserCancelledError);
+                                           [done fulfill];
+                                       }];
+        [task cancel];
+        Assert(task.isCancelled);
+    }
+    [self waitForExpectations: @[done] timeout: 10.0];
+}
+
+- (void) testCloseCancelsIncrementalMaintenance {
+    XCTestExpectation* done = [self expectationWithDescription: @"maintenance done"];
+    dispatch_queue_t queue = dispatch_queue_create("maintenance", DISPATCH_QUEUE_SERIAL);
+    CBLMaintenanceTask* task;
+    @synchronized (_db.mutex) {
+        task = [_db performIncrementalMaintenance: kCBLMaintenanceTypeFullOptimize
+                                        timeSlice: 0
+                                            queue: queue
+                                         progress: nil
+                                       completion: ^(NSError* err) {
+                                           AssertEqual(err.code, NSUserCancelledError);
+                                           [done fulfill];
+                                       }];
+        AssertEqual(_db.activeStoppableCount, 1u);
+    }
+    
+    NSError* error;
+    Assert([_db close: &error], @"Couldn't close db: %@", error);
+    Assert(task.isCancelled);
+    [self waitForExpectations: @[done] timeout: 10.0];
+}
+
 - (void) testPerformMaintenanceReindex {
     // Create docs:
     [self createDocs: 20];
@@ -0,0 +1,84 @@
+//
+//  DateFormatPerfTest.m
+//  CouchbaseLite
+//
+//  Copyright (c) 2022 Couchbase, Inc All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import "DateFormatPerfTest.h"
+#import "CBLJSON.h"
+
+
+@implementation DateFormatPerfTest
+{
+    NSArray<NSDate*>* _dates;
+}
+
+
+- (void) setUp {
+    [super setUp];
+    const unsigned count = 100000;
+    NSMutableArray* dates = [NSMutableArray arrayWithCapacity: count];
+    for (unsigned i = 0; i < count; i++) {
+        double t = ((double)arc4random() / UINT32_MAX) * 2.0e9;
+        [dates addObject: [NSDate dateWithTimeIntervalSince1970: t]];
+    }
+    _dates = dates;
+}
+
+
+- (void) test {
+    NSArray<NSDate*>* dates = _dates;
+
+    NSLog(@"--- Formatting %lu dates with NSDateFormatter ---", (unsigned long)dates.count);
+    NSDateFormatter* formatter = [[NSDateFormatter alloc] init];
+    formatter.dateFormat = @"uuuu-MM-dd'T'HH:mm:ss.SSSXXX";
+    formatter.calendar = [[NSCalendar alloc] initWithCalendarIdentifier: NSCalendarIdentifierGregorian];
+    formatter.locale = [[NSLocale alloc] initWithLocaleIdentifier: @"en_US"];
+    formatter.timeZone = [NSTimeZone timeZoneForSecondsFromGMT: 0];
+    [self measureAtScale: dates.count unit: @"date" block:^{
+        for (NSDate* date in dates) {
+            @autoreleasepool {
+                @synchronized (formatter) {
+                    [formatter stringFromDate: date];
+                }
+            }
+        }
+    }];
+
+    NSLog(@"--- Formatting %lu dates with CBLJSON ---", (unsigned long)dates.count);
+    [self measureAtScale: dates.count unit: @"date" block:^{
+        for (NSDate* date in dates) {
+            @autoreleasepool {
+                [CBLJSON JSONObjectWithDate: date];
+            }
+        }
+    }];
+
+    NSLog(@"--- Formatting %lu dates with CBLJSON on 4 threads at once ---",
+          (unsigned long)dates.count);
+    [self measureAtScale: 4 * dates.count unit: @"date" block:^{
+        dispatch_apply(4, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t n) {
+            for (NSDate* date in dates) {
+                @autoreleasepool {
+                    [CBLJSON JSONObjectWithDate: date];
+                }
+            }
+        });
+    }];
+}
+
+
+@end
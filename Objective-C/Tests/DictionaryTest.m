@@ -331,6 +331,36 @@
     }];
 }
 
+- (void) testMutatingWhileEnumeratingKeys {
+    // A new document's properties aren't backed by Fleece until it's saved:
+    CBLMutableDocument* doc = [self createDocument];
+    for (NSInteger i = 0; i < 20; i++) {
+        [doc setValue: @(i) forKey: [NSString stringWithFormat:@"key%ld", (long)i]];
+    }
+    
+    // Replacing the values of existing keys is allowed:
+    for (NSString* key in doc) {
+        [doc setValue: @([doc integerForKey: key] + 1) forKey: key];
+    }
+    AssertEqual([doc integerForKey: @"key0"], 1);
+    AssertEqual([doc integerForKey: @"key19"], 20);
+    
+    // Adding or removing keys raises:
+    [self expectException: @"NSGenericException" in: ^{
+        for (NSString* key in doc) {
+            [doc removeValueForKey: key];
+        }
+    }];
+    AssertEqual(doc.count, 19u);
+    
+    [self expectException: @"NSGenericException" in: ^{
+        for (NSString* key in doc) {
+            [doc setValue: @(0) forKey: [key stringByAppendingString: @"-new"]];
+        }
+    }];
+    AssertEqual(doc.count, 20u);
+}
+
 - (void) testToMutable {
     CBLMutableDictionary* mDict1 = [[CBLMutableDictionary alloc] init];
     [mDict1 setValue: @"Scott" forKey: @"name"];
@@ -403,6 +433,113 @@
     }];
 }
 
+#pragma mark - Key Paths
+
+- (CBLDocument*) saveKeyPathDocument {
+    CBLMutableDocument* doc = [self createDocument: @"doc1"];
+    [doc setData: @{@"name": @"Scott",
+                    @"address": @{@"street": @"1 Main street", @"city": @"Mountain View"},
+                    @"phones": @[@{@"type": @"home", @"number": @"650-123-0001"},
+                                 @{@"type": @"mobile", @"number": @"650-123-0002"}],
+                    @"a.b": @{@"c[0]": @"escaped"}}];
+    [self saveDocument: doc];
+    return [self.db documentWithID: doc.id];
+}
+
+- (void) testValueAtKeyPath {
+    CBLDocument* doc = [self saveKeyPathDocument];
+    AssertEqualObjects([doc valueAtKeyPath: @"name"], @"Scott");
+    AssertEqualObjects([doc valueAtKeyPath: @"address.city"], @"Mountain View");
+    AssertEqualObjects([doc valueAtKeyPath: @"phones[1].number"], @"650-123-0002");
+    AssertEqualObjects([doc valueAtKeyPath: @"phones[-2].type"], @"home");
+    AssertEqualObjects([doc valueAtKeyPath: @"$.address.street"], @"1 Main street");
+    AssertEqualObjects([doc valueAtKeyPath: @"a\\.b.c\\[0]"], @"escaped");
+    AssertEqualObjects([[doc valueAtKeyPath: @"address"] toDictionary],
+                       (@{@"street": @"1 Main street", @"city": @"Mountain View"}));
+    AssertEqualObjects([[doc valueAtKeyPath: @"phones"] valueAtIndex: 0],
+                       [[doc arrayForKey: @"phones"] valueAtIndex: 0]);
+    
+    // Missing values, and paths that don't match the structure:
+    AssertNil([doc valueAtKeyPath: @"address.zip"]);
+    AssertNil([doc valueAtKeyPath: @"phones[2].number"]);
+    AssertNil([doc valueAtKeyPath: @"phones[-3]"]);
+    AssertNil([doc valueAtKeyPath: @"name.first"]);
+    AssertNil([doc valueAtKeyPath: @"address[0]"]);
+    AssertNil([doc valueAtKeyPath: @"[0]"]);
+    
+    // A nested dictionary works the same as the document:
+    CBLDictionary* address = [doc dictionaryForKey: @"address"];
+    AssertEqualObjects([address valueAtKeyPath: @"street"], @"1 Main street");
+    
+    CBLKeyPath* number = [CBLKeyPath keyPathWithString: @"phones[0].number" error: nil];
+    AssertEqualObjects(number.path, @"phones[0].number");
+    AssertEqualObjects([doc valueAtCompiledKeyPath: number], @"650-123-0001");
+    AssertEqualObjects([[doc toMutable] valueAtCompiledKeyPath: number], @"650-123-0001");
+}
+
+- (void) testValueAtKeyPathOnTwoDatabases {
+    CBLDocument* doc = [self saveKeyPathDocument];
+    
+    // Give the nested keys different shared-key numbers in the other database:
+    [self openOtherDB];
+    CBLCollection* otherCollection = [self.otherDB defaultCollection: nil];
+    NSArray* keys = @[@"zip", @"number", @"street", @"type", @"city"];
+    for (NSUInteger i = 0; i < keys.count; i++) {
+        CBLMutableDocument* mDoc = [self createDocument: [NSString stringWithFormat: @"key%lu",
+                                                          (unsigned long)i]];
+        [mDoc setValue: @{keys[i]: @(i)} forKey: @"nested"];
+        [self saveDocument: mDoc collection: otherCollection];
+    }
+    CBLMutableDocument* mDoc = [self createDocument: @"other"];
+    [mDoc setValue: @{@"city": @"Santa Clara", @"zip": @"95054"} forKey: @"address"];
+    [self saveDocument: mDoc collection: otherCollection];
+    CBLDocument* otherDoc = [otherCollection documentWithID: @"other" error: nil];
+    
+    CBLKeyPath* city = [CBLKeyPath keyPathWithString: @"address.city" error: nil];
+    for (int round = 0; round < 2; round++) {
+        AssertEqualObjects([doc valueAtCompiledKeyPath: city], @"Mountain View");
+        AssertEqualObjects([otherDoc valueAtCompiledKeyPath: city], @"Santa Clara");
+        AssertEqualObjects([doc valueAtKeyPath: @"address.city"], @"Mountain View");
+        AssertEqualObjects([otherDoc valueAtKeyPath: @"address.city"], @"Santa Clara");
+        AssertNil([doc valueAtKeyPath: @"address.zip"]);
+        AssertEqualObjects([otherDoc valueAtKeyPath: @"address.zip"], @"95054");
+    }
+}
+
+- (void) testInvalidKeyPath {
+    for (NSString* path in @[@"", @"$", @"a..b", @"a.", @"a[", @"a[x]", @"a[-]", @"a[0]b", @"a\\"]) {
+        [self expectError: CBLErrorDomain code: CBLErrorInvalidParameter in: ^BOOL(NSError** err) {
+            return [CBLKeyPath keyPathWithString: path error: err] != nil;
+        }];
+    }
+    
+    CBLDocument* doc = [self saveKeyPathDocument];
+    [self expectException: @"NSInvalidArgumentException" in: ^{
+        [doc valueAtKeyPath: @"address..city"];
+    }];
+}
+
+- (void) testValueAtKeyPathWithUnsavedChanges {
+    CBLMutableDocument* doc = [[self saveKeyPathDocument] toMutable];
+    [[doc dictionaryForKey: @"address"] setValue: @"Palo Alto" forKey: @"city"];
+    [[[doc arrayForKey: @"phones"] dictionaryAtIndex: 1] setValue: @"work" forKey: @"type"];
+    [doc setValue: @{@"first": @"Scott", @"last": @"Tiger"} forKey: @"name"];
+    
+    AssertEqualObjects([doc valueAtKeyPath: @"address.city"], @"Palo Alto");
+    AssertEqualObjects([doc valueAtKeyPath: @"address.street"], @"1 Main street");
+    AssertEqualObjects([doc valueAtKeyPath: @"phones[-1].type"], @"work");
+    AssertEqualObjects([doc valueAtKeyPath: @"phones[0].type"], @"home");
+    AssertEqualObjects([doc valueAtKeyPath: @"name.last"], @"Tiger");
+    
+    // A collection at the end of the path is the same object as the chained getters return:
+    CBLMutableDictionary* address = [doc valueAtKeyPath: @"address"];
+    AssertEqual(address, [doc dictionaryForKey: @"address"]);
+    
+    CBLMutableDictionary* dict = [[CBLMutableDictionary alloc] initWithData: @{@"x": @[@1, @{@"y": @2}]}];
+    AssertEqualObjects([dict valueAtKeyPath: @"x[1].y"], @2);
+    AssertNil([dict valueAtKeyPath: @"x[2].y"]);
+}
+
 #pragma clang diagnostic pop
 
 @end
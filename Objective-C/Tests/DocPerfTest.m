@@ -18,6 +18,7 @@
 //
 
 #import "DocPerfTest.h"
+#import <malloc/malloc.h>
 
 
 @implementation DocPerfTest
@@ -27,11 +28,84 @@
 #pragma clang diagnostic ignored "-Wdeprecated-declarations"
 
 - (void) test {
+    const unsigned creates = 10000;
+    NSLog(@"--- Creating %u new documents ---", creates);
+    [self measureAtScale: creates unit: @"document" block:^{
+        [self createNewDocuments: creates];
+    }];
+
     const unsigned revs = 10000;
     NSLog(@"--- Creating %u revisions ---", revs);
     [self measureAtScale: revs unit: @"revision" block:^{
         [self addRevisions: revs];
     }];
+
+    const unsigned updates = 100;
+    NSLog(@"--- Updating one field of a 1MB document %u times ---", updates);
+    [self createLargeDocument];
+    [self measureAtScale: updates unit: @"update" block:^{
+        [self updateLargeDocument: updates];
+    }];
+
+    const unsigned docs = 10000;
+    NSLog(@"--- Reading %u documents ---", docs);
+    [self createSmallDocuments: docs];
+    [self measureAtScale: docs unit: @"read" block:^{
+        [self readSmallDocuments: docs];
+    }];
+    [self measureHeapPerDocument: docs];
+
+    const unsigned batch = 2000;
+    NSLog(@"--- Reading %u documents in batches of %u ---", docs, batch);
+    [self measureAtScale: docs unit: @"read" block:^{
+        [self readSmallDocuments: docs batchSize: batch];
+    }];
+
+    const unsigned reads = 100000;
+    NSLog(@"--- Reading typed properties %u times, half of them type mismatches ---", reads);
+    CBLDocument* doc = [self createTypedDocument];
+    [self measureAtScale: reads * 4 unit: @"getter call" block:^{
+        [self readTypedProperties: doc count: reads];
+    }];
+
+    NSLog(@"--- Reading a nested property %u times with chained getters ---", reads);
+    CBLDocument* nested = [self createNestedDocument];
+    [self measureAtScale: reads unit: @"lookup" block:^{
+        [self readNestedProperty: nested count: reads];
+    }];
+    NSLog(@"--- Reading a nested property %u times with a compiled key path ---", reads);
+    CBLKeyPath* keyPath = [CBLKeyPath keyPathWithString: @"phones[1].number" error: nil];
+    [self measureAtScale: reads unit: @"lookup" block:^{
+        [self readNestedProperty: nested keyPath: keyPath count: reads];
+    }];
+
+    const unsigned dateReads = 100;
+    NSLog(@"--- Reading a date property of %u documents %u times ---", docs, dateReads);
+    NSArray<CBLDocument*>* dated = [self createDatedDocuments: docs];
+    [self measureAtScale: docs * dateReads unit: @"read" block:^{
+        [self readDates: dated count: dateReads];
+    }];
+}
+
+
+// Creates documents with generated IDs, so each run adds new ones rather than updating.
+- (void) createNewDocuments: (unsigned)numDocs {
+    NSError *error;
+    BOOL ok = [self.db inBatch: &error usingBlock: ^{
+        for (unsigned i = 0; i < numDocs; ++i) {
+            @autoreleasepool {
+                CBLMutableDocument* doc = [[CBLMutableDocument alloc] init];
+                [doc setString: @"Scott" forKey: @"name"];
+                [doc setInteger: i forKey: @"index"];
+                [doc setDouble: i / 10.0 forKey: @"score"];
+                [doc setBoolean: (i % 2) == 0 forKey: @"even"];
+                [doc setString: @"Mountain View" forKey: @"city"];
+                NSError *error2;
+                Assert([self.db saveDocument: doc error: &error2], @"Save failed: %@", error2);
+            }
+        }
+    }];
+    Assert(ok);
 }
 
 
@@ -52,6 +126,193 @@
     Assert(ok);
 }
 
+
+// Creates a document of about 1MB: 1000 nested dictionaries with 1KB of strings each.
+- (void) createLargeDocument {
+    NSString* filler = [@"" stringByPaddingToLength: 100 withString: @"0123456789" startingAtIndex: 0];
+    NSMutableDictionary* items = [NSMutableDictionary dictionary];
+    for (unsigned i = 0; i < 1000; ++i) {
+        NSMutableDictionary* item = [NSMutableDictionary dictionary];
+        for (unsigned j = 0; j < 10; ++j)
+            item[[NSString stringWithFormat: @"field%u", j]] = [NSString stringWithFormat: @"%u-%@", j, filler];
+        items[[NSString stringWithFormat: @"item%04u", i]] = item;
+    }
+    CBLMutableDocument* doc = [CBLMutableDocument documentWithID: @"large"];
+    [doc setValue: items forKey: @"items"];
+    [doc setValue: @{@"count": @0} forKey: @"stats"];
+    NSError *error;
+    Assert([self.db saveDocument: doc error: &error], @"Save failed: %@", error);
+}
+
+
+- (void) updateLargeDocument: (unsigned)numUpdates {
+    for (unsigned i = 0; i < numUpdates; ++i) {
+        @autoreleasepool {
+            CBLMutableDocument* doc = [[self.db documentWithID: @"large"] toMutable];
+            [[doc dictionaryForKey: @"stats"] setValue: @(i) forKey: @"count"];
+            NSError *error;
+            Assert([self.db saveDocument: doc error: &error], @"Save failed: %@", error);
+        }
+    }
+}
+
+- (void) createSmallDocuments: (unsigned)numDocs {
+    NSError *error;
+    BOOL ok = [self.db inBatch: &error usingBlock: ^{
+        for (unsigned i = 0; i < numDocs; ++i) {
+            @autoreleasepool {
+                CBLMutableDocument* doc = [CBLMutableDocument documentWithID:
+                                           [NSString stringWithFormat: @"small-%05u", i]];
+                [doc setString: @"Scott" forKey: @"name"];
+                [doc setInteger: i forKey: @"index"];
+                NSError *error2;
+                Assert([self.db saveDocument: doc error: &error2], @"Save failed: %@", error2);
+            }
+        }
+    }];
+    Assert(ok);
+}
+
+
+// Reads each document once and lets it go, like a scan does.
+- (void) readSmallDocuments: (unsigned)numDocs {
+    for (unsigned i = 0; i < numDocs; ++i) {
+        @autoreleasepool {
+            CBLDocument* doc = [self.db documentWithID: [NSString stringWithFormat: @"small-%05u", i]];
+            Assert([doc integerForKey: @"index"] == i);
+        }
+    }
+}
+
+
+// Reads the documents with -documentsWithIDs:, asking for each batch in a shuffled order.
+- (void) readSmallDocuments: (unsigned)numDocs batchSize: (unsigned)batchSize {
+    CBLCollection* collection = [self.db defaultCollection: nil];
+    for (unsigned start = 0; start < numDocs; start += batchSize) {
+        @autoreleasepool {
+            unsigned count = MIN(batchSize, numDocs - start);
+            NSMutableArray* docIDs = [NSMutableArray arrayWithCapacity: count];
+            for (unsigned i = 0; i < count; ++i) {
+                unsigned index = start + (i * 7919) % count;    // 7919 is prime, so all are hit
+                [docIDs addObject: [NSString stringWithFormat: @"small-%05u", index]];
+            }
+            NSError* error;
+            NSArray<CBLDocument*>* batch = [collection documentsWithIDs: docIDs error: &error];
+            Assert(batch.count == count, @"Batch read failed: %@", error);
+            for (CBLDocument* doc in batch)
+                [doc integerForKey: @"index"];
+        }
+    }
+}
+
+
+- (CBLDocument*) createTypedDocument {
+    CBLMutableDocument* doc = [CBLMutableDocument documentWithID: @"typed"];
+    [doc setString: @"Scott" forKey: @"name"];
+    [doc setInteger: 42 forKey: @"age"];
+    [doc setValue: @{@"street": @"1 Main Street", @"city": @"Mountain View"} forKey: @"address"];
+    NSError *error;
+    Assert([self.db saveDocument: doc error: &error], @"Save failed: %@", error);
+    return [self.db documentWithID: @"typed"];
+}
+
+
+// Type mismatches return nil, and shouldn't cost more than a matching read.
+- (void) readTypedProperties: (CBLDocument*)doc count: (unsigned)count {
+    for (unsigned n = 0; n < count; ++n) {
+        @autoreleasepool {
+            [doc stringForKey: @"name"];
+            [doc numberForKey: @"age"];
+            [doc stringForKey: @"address"];
+            [doc numberForKey: @"name"];
+        }
+    }
+}
+
+
+- (CBLDocument*) createNestedDocument {
+    CBLMutableDocument* doc = [CBLMutableDocument documentWithID: @"nested"];
+    [doc setValue: @[@{@"type": @"home", @"number": @"650-123-0001"},
+                     @{@"type": @"mobile", @"number": @"650-123-0002"}] forKey: @"phones"];
+    NSError *error;
+    Assert([self.db saveDocument: doc error: &error], @"Save failed: %@", error);
+    return [self.db documentWithID: @"nested"];
+}
+
+
+- (void) readNestedProperty: (CBLDocument*)doc count: (unsigned)count {
+    for (unsigned n = 0; n < count; ++n) {
+        @autoreleasepool {
+            NSString* number = [[[doc arrayForKey: @"phones"] dictionaryAtIndex: 1]
+                                stringForKey: @"number"];
+            Assert([number isEqualToString: @"650-123-0002"]);
+        }
+    }
+}
+
+
+- (void) readNestedProperty: (CBLDocument*)doc keyPath: (CBLKeyPath*)keyPath count: (unsigned)count {
+    for (unsigned n = 0; n < count; ++n) {
+        @autoreleasepool {
+            NSString* number = [doc valueAtCompiledKeyPath: keyPath];
+            Assert([number isEqualToString: @"650-123-0002"]);
+        }
+    }
+}
+
+
+- (NSArray<CBLDocument*>*) createDatedDocuments: (unsigned)numDocs {
+    NSDate* date = [NSDate dateWithTimeIntervalSince1970: 1486318446.347];
+    NSError *error;
+    BOOL ok = [self.db inBatch: &error usingBlock: ^{
+        for (unsigned i = 0; i < numDocs; ++i) {
+            @autoreleasepool {
+                CBLMutableDocument* doc = [CBLMutableDocument documentWithID:
+                                           [NSString stringWithFormat: @"dated-%05u", i]];
+                [doc setDate: [date dateByAddingTimeInterval: i] forKey: @"date"];
+                NSError *error2;
+                Assert([self.db saveDocument: doc error: &error2], @"Save failed: %@", error2);
+            }
+        }
+    }];
+    Assert(ok);
+    NSMutableArray* docs = [NSMutableArray arrayWithCapacity: numDocs];
+    for (unsigned i = 0; i < numDocs; ++i)
+        [docs addObject: [self.db documentWithID: [NSString stringWithFormat: @"dated-%05u", i]]];
+    return docs;
+}
+
+
+// Like a sort comparator reading the same date field over and over.
+- (void) readDates: (NSArray<CBLDocument*>*)docs count: (unsigned)count {
+    for (unsigned n = 0; n < count; ++n) {
+        @autoreleasepool {
+            for (CBLDocument* doc in docs)
+                [doc dateForKey: @"date"];
+        }
+    }
+}
+
+
+// Logs how many heap blocks and bytes each document holds while it's open.
+- (void) measureHeapPerDocument: (unsigned)numDocs {
+    NSMutableArray* docs = [NSMutableArray arrayWithCapacity: numDocs];
+    malloc_statistics_t before, after;
+    malloc_zone_statistics(NULL, &before);
+    @autoreleasepool {
+        for (unsigned i = 0; i < numDocs; ++i) {
+            CBLDocument* doc = [self.db documentWithID: [NSString stringWithFormat: @"small-%05u", i]];
+            [doc integerForKey: @"index"];
+            [docs addObject: doc];
+        }
+    }
+    malloc_zone_statistics(NULL, &after);
+    NSLog(@"Each open document uses %.1f heap blocks, %.0f bytes",
+          (double)(after.blocks_in_use - before.blocks_in_use) / numDocs,
+          (double)(after.size_in_use - before.size_in_use) / numDocs);
+    [docs removeAllObjects];
+}
+
 #pragma clang diagnostic pop
 
 @end
@@ -0,0 +1,78 @@
+//
+//  DocViewPerfTest.mm
+//  CouchbaseLite
+//
+//  Copyright (c) 2022 Couchbase, Inc All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import "DocViewPerfTest.h"
+#import "CBLDocView.hh"
+
+using namespace fleece;
+
+
+namespace {
+    struct PersonSchema {
+        static constexpr std::array<slice, 3> kKeys {"name"_sl, "age"_sl, "height"_sl};
+        static constexpr cbl::Field<slice, 0>       name {};
+        static constexpr cbl::Field<int64_t, 1>     age {};
+        static constexpr cbl::Field<double, 2>      height {};
+    };
+}
+
+
+@implementation DocViewPerfTest
+
+
+- (void) test {
+    const unsigned reads = 1000000;
+    CBLMutableDocument* mDoc = [CBLMutableDocument documentWithID: @"person"];
+    [mDoc setString: @"Scott" forKey: @"name"];
+    [mDoc setInteger: 42 forKey: @"age"];
+    [mDoc setDouble: 1.85 forKey: @"height"];
+    CBLCollection* collection = [self.db defaultCollection: nil];
+    NSError* error;
+    Assert([collection saveDocument: mDoc error: &error], @"Save failed: %@", error);
+    CBLDocument* doc = [collection documentWithID: @"person" error: &error];
+    Assert(doc, @"Couldn't read doc: %@", error);
+
+    NSLog(@"--- Reading 3 properties %u times with CBLDocument getters ---", reads);
+    [self measureAtScale: reads unit: @"read" block:^{
+        int64_t total = 0;
+        for (unsigned n = 0; n < reads; n++) {
+            @autoreleasepool {
+                total += [doc integerForKey: @"age"];
+                total += [doc doubleForKey: @"height"];
+                total += [doc stringForKey: @"name"].length;
+            }
+        }
+        Assert(total == (int64_t)reads * (42 + 1 + 5));
+    }];
+
+    NSLog(@"--- Reading 3 properties %u times with a DocView ---", reads);
+    [self measureAtScale: reads unit: @"read" block:^{
+        int64_t total = 0;
+        for (unsigned n = 0; n < reads; n++) {
+            cbl::DocView<PersonSchema> person(doc);
+            total += person[PersonSchema::age];
+            total += person[PersonSchema::height];
+            total += person[PersonSchema::name].size;
+        }
+        Assert(total == (int64_t)reads * (42 + 1 + 5));
+    }];
+}
+
+
+@end
@@ -20,6 +20,7 @@
 #import "CBLTestCase.h"
 
 #import "CBLBlob.h"
+#import "CBLDocument+Internal.h"
 #import "CBLJSON.h"
 #import "Foundation+CBL.h"
 
@@ -680,6 +681,89 @@
     }];
 }
 
+- (void) testGetDateRepeatedly {
+    NSDate* date = [NSDate dateWithTimeIntervalSince1970: 1486318446.347];
+    CBLMutableDocument* mDoc = [self createDocument: @"doc1"];
+    [mDoc setDate: date forKey: @"date"];
+    [self saveDocument: mDoc];
+    CBLDocument* doc = [self.db documentWithID: @"doc1"];
+    
+    // Like a sort comparator reading the same date field over and over; the timing is in
+    // DocPerfTest:
+    for (NSUInteger n = 0; n < 3; n++) {
+        XCTAssertEqualWithAccuracy([doc dateForKey: @"date"].timeIntervalSince1970,
+                                   date.timeIntervalSince1970, 0.001);
+    }
+}
+
+- (void) testTypedGetterTypeMismatch {
+    CBLMutableDocument* mDoc = [self createDocument: @"doc1"];
+    [mDoc setString: @"Scott" forKey: @"name"];
+    [mDoc setInteger: 42 forKey: @"age"];
+    [mDoc setValue: @{@"street": @"1 Main Street", @"city": @"Mountain View"} forKey: @"address"];
+    [self saveDocument: mDoc];
+    CBLDocument* doc = [self.db documentWithID: @"doc1"];
+    
+    AssertEqualObjects([doc stringForKey: @"name"], @"Scott");
+    AssertEqualObjects([doc numberForKey: @"age"], @42);
+    // Type mismatches return nil without instantiating the value:
+    AssertNil([doc stringForKey: @"address"]);
+    AssertNil([doc numberForKey: @"name"]);
+    AssertNil([doc arrayForKey: @"age"]);
+}
+
+- (void) testNewDocumentProperties {
+    CBLMutableDocument* doc = [self createDocument: @"doc1"];
+    [doc setInteger: 42 forKey: @"int"];
+    [doc setLongLong: 1LL << 40 forKey: @"longlong"];
+    [doc setDouble: 1.5 forKey: @"double"];
+    [doc setFloat: 2.5f forKey: @"float"];
+    [doc setBoolean: YES forKey: @"bool"];
+    [doc setString: @"Scott" forKey: @"name"];
+    
+    // Scalars can be read back as any numeric type, or as NSNumbers:
+    AssertEqual([doc integerForKey: @"int"], 42);
+    AssertEqual([doc doubleForKey: @"int"], 42.0);
+    AssertEqual([doc longLongForKey: @"longlong"], 1LL << 40);
+    AssertEqual([doc integerForKey: @"double"], 1);
+    AssertEqual([doc floatForKey: @"float"], 2.5f);
+    Assert([doc booleanForKey: @"bool"]);
+    AssertEqualObjects([doc valueForKey: @"int"], @42);
+    AssertEqualObjects([doc numberForKey: @"double"], @1.5);
+    AssertNil([doc stringForKey: @"int"]);
+    AssertNil([doc dateForKey: @"bool"]);
+    AssertEqualObjects(doc.keys, (@[@"int", @"longlong", @"double", @"float", @"bool", @"name"]));
+    
+    // Setting an equal value, even with a different type, isn't a change:
+    [doc setNumber: @42 forKey: @"int"];
+    AssertEqualObjects([doc valueForKey: @"int"], @42);
+    [doc setValue: @"Tiger" forKey: @"int"];
+    AssertEqualObjects([doc valueForKey: @"int"], @"Tiger");
+    
+    // Past the linear-search limit, lookups go through an index:
+    for (int i = 0; i < 40; i++)
+        [doc setInteger: i forKey: [NSString stringWithFormat: @"key%d", i]];
+    AssertEqual(doc.count, 46u);
+    AssertEqual([doc integerForKey: @"key33"], 33);
+    [doc removeValueForKey: @"key10"];
+    AssertFalse([doc containsValueForKey: @"key10"]);
+    AssertEqual([doc integerForKey: @"key11"], 11);
+    [doc setInteger: 10 forKey: @"key10"];
+    AssertEqual([doc integerForKey: @"key10"], 10);
+    AssertEqualObjects(doc.keys.lastObject, @"key10");
+    
+    [self saveDocument: doc eval: ^(CBLDocument* d) {
+        AssertEqual(d.count, 46u);
+        AssertEqual([d integerForKey: @"key39"], 39);
+        AssertEqual([d longLongForKey: @"longlong"], 1LL << 40);
+        AssertEqual([d doubleForKey: @"double"], 1.5);
+        AssertEqual([d floatForKey: @"float"], 2.5f);
+        Assert([d booleanForKey: @"bool"]);
+        AssertEqualObjects([d stringForKey: @"int"], @"Tiger");
+        AssertEqualObjects([d stringForKey: @"name"], @"Scott");
+    }];
+}
+
 - (void) testGetDate {
     CBLMutableDocument* doc = [self createDocument: @"doc1"];
     [self populateData: doc];
@@ -2075,6 +2159,41 @@
     }];
 }
 
+- (void) testMutateDocumentFromJSON {
+    NSError* err;
+    NSString* json = @"{\"name\":\"Scott\",\"age\":30,"
+                      "\"address\":{\"city\":\"Palo Alto\",\"zip\":94301},"
+                      "\"phones\":[\"650-123-0001\",\"650-123-0002\"]}";
+    CBLMutableDocument* mDoc = [[CBLMutableDocument alloc] initWithID: @"doc" json: json error: &err];
+    AssertNotNil(mDoc, @"Error: %@", err);
+    AssertEqualObjects([mDoc stringForKey: @"name"], @"Scott");
+    AssertEqual([mDoc integerForKey: @"age"], 30);
+    
+    // Mutate nested collections of the JSON-backed document:
+    [[mDoc dictionaryForKey: @"address"] setValue: @"Mountain View" forKey: @"city"];
+    [[mDoc arrayForKey: @"phones"] addValue: @"650-123-0003"];
+    [mDoc setValue: @"scott@example.com" forKey: @"email"];
+    
+    NSDictionary* expected = @{@"name": @"Scott",
+                               @"age": @30,
+                               @"address": @{@"city": @"Mountain View", @"zip": @94301},
+                               @"phones": @[@"650-123-0001", @"650-123-0002", @"650-123-0003"],
+                               @"email": @"scott@example.com"};
+    AssertEqualObjects([mDoc toDictionary], expected);
+    
+    [self saveDocument: mDoc eval: ^(CBLDocument* d) {
+        AssertEqualObjects([d toDictionary], expected);
+    }];
+    
+    // Replace the content of a saved document:
+    mDoc = [[self.db documentWithID: @"doc"] toMutable];
+    Assert([mDoc setJSON: @"{\"name\":\"Daniel\"}" error: &err], @"Error: %@", err);
+    AssertEqualObjects([mDoc toDictionary], @{@"name": @"Daniel"});
+    [self saveDocument: mDoc eval: ^(CBLDocument* d) {
+        AssertEqualObjects([d toDictionary], @{@"name": @"Daniel"});
+    }];
+}
+
 - (void) testSpecialJSONStrings {
     NSError* err;
     CBLMutableDocument* doc;
@@ -2233,6 +2352,66 @@
     AssertEqual(blob.length, 0);
 }
 
+#pragma mark - Change Tracking
+
+- (void) saveNestedDocument {
+    CBLMutableDocument* doc = [self createDocument: @"doc1"];
+    NSData* content = [kDocumentTestBlob dataUsingEncoding: NSUTF8StringEncoding];
+    [doc setData: @{@"name": @"Scott",
+                    @"address": @{@"street": @"1 Main street", @"city": @"Mountain View"},
+                    @"tags": @[@"a", @"b"],
+                    @"photo": [[CBLBlob alloc] initWithContentType: @"text/plain" data: content]}];
+    [self saveDocument: doc];
+}
+
+- (void) testReassignedValuesAreNotChanges {
+    [self saveNestedDocument];
+    
+    CBLMutableDocument* doc = [[self.db documentWithID: @"doc1"] toMutable];
+    [doc setDictionary: [doc dictionaryForKey: @"address"] forKey: @"address"];
+    [doc setArray: [doc arrayForKey: @"tags"] forKey: @"tags"];
+    [doc setString: @"Scott" forKey: @"name"];
+    AssertFalse(doc.changed);
+    
+    // Modifying a nested collection in place, then putting it back, is a change:
+    CBLMutableDictionary* address = [doc dictionaryForKey: @"address"];
+    [address setString: @"Palo Alto" forKey: @"city"];
+    [doc setDictionary: address forKey: @"address"];
+    Assert(doc.changed);
+    
+    // A different collection with the same contents is still assumed to be a change:
+    doc = [[self.db documentWithID: @"doc1"] toMutable];
+    [doc setArray: [[CBLMutableArray alloc] initWithData: @[@"a", @"b"]] forKey: @"tags"];
+    Assert(doc.changed);
+}
+
+- (void) testSaveUnchangedDocument {
+    [self saveNestedDocument];
+    CBLDocument* saved = [self.db documentWithID: @"doc1"];
+    
+    // Saving an unchanged document reuses the body of the current revision:
+    CBLMutableDocument* doc = [saved toMutable];
+    [doc setDictionary: [doc dictionaryForKey: @"address"] forKey: @"address"];
+    NSError* error;
+    Assert([self.db saveDocument: doc error: &error], @"Save failed: %@", error);
+    
+    CBLDocument* resaved = [self.db documentWithID: @"doc1"];
+    AssertEqual(resaved.sequence, saved.sequence + 1);
+    AssertEqualObjects([resaved toJSON], [saved toJSON]);
+    Assert(resaved.c4Doc.revFlags & kRevHasAttachments);
+    
+    // After a nested change the document is encoded again:
+    doc = [resaved toMutable];
+    [[doc dictionaryForKey: @"address"] setString: @"Palo Alto" forKey: @"city"];
+    Assert([self.db saveDocument: doc error: &error], @"Save failed: %@", error);
+    
+    resaved = [self.db documentWithID: @"doc1"];
+    AssertEqualObjects([resaved valueAtKeyPath: @"address.city"], @"Palo Alto");
+    AssertEqualObjects([resaved valueAtKeyPath: @"address.street"], @"1 Main street");
+    AssertEqualObjects([[resaved arrayForKey: @"tags"] toArray], (@[@"a", @"b"]));
+    Assert(resaved.c4Doc.revFlags & kRevHasAttachments);
+}
+
 #pragma clang diagnostic pop
 
 @end
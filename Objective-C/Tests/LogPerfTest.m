@@ -0,0 +1,59 @@
+//
+//  LogPerfTest.m
+//  CouchbaseLite
+//
+//  Copyright (c) 2022 Couchbase, Inc All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import "LogPerfTest.h"
+#import "CBLLog+Logging.h"
+
+
+@implementation LogPerfTest
+{
+    CBLLogLevel _consoleLevel, _fileLevel;
+}
+
+
+- (void) setUp {
+    [super setUp];
+    _consoleLevel = CBLDatabase.log.console.level;
+    _fileLevel = CBLDatabase.log.file.level;
+    CBLDatabase.log.console.level = kCBLLogLevelWarning;
+    CBLDatabase.log.file.level = kCBLLogLevelWarning;
+}
+
+
+- (void) test {
+    // None of these should format a message:
+    const unsigned calls = 10000000;
+    NSString* arg = @"doc-1";
+    NSLog(@"--- Making %u log calls below the log level ---", calls);
+    [self measureAtScale: calls unit: @"call" block:^{
+        for (unsigned i = 0; i < calls; i++) {
+            CBLLogVerbose(Database, @"Disabled log call #%u for %@", i, arg);
+        }
+    }];
+}
+
+
+- (void) tearDown {
+    CBLDatabase.log.console.level = _consoleLevel;
+    CBLDatabase.log.file.level = _fileLevel;
+    [super tearDown];
+}
+
+
+@end
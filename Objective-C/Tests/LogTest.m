@@ -19,6 +19,7 @@
 
 #import "CBLTestCase.h"
 #import "CBLLog+Logging.h"
+#import "CBLLog+Swift.h"
 #import "CustomLogger.h"
 
 @interface FileLoggerBackup: NSObject
@@ -76,6 +77,7 @@
         _backup = nil;
     }
     CBLDatabase.log.custom = nil;
+    CBLDatabase.log.asynchronous = NO;
     CBLDatabase.log.console.level = _backupConsoleLevel;
     CBLDatabase.log.console.domains = _backupConsoleDomain;
     
@@ -425,6 +427,99 @@
     Assert(found);
 }
 
+- (void) testDisabledLogCall {
+    CustomLogger* customLogger = [[CustomLogger alloc] init];
+    customLogger.level = kCBLLogLevelWarning;
+    CBLDatabase.log.custom = customLogger;
+    
+    // Calls below the level don't reach the logger; the timing is in LogPerfTest:
+    NSString* arg = @"doc-1";
+    for (NSUInteger i = 0; i < 100; i++) {
+        CBLLogVerbose(Database, @"Disabled log call #%lu for %@", (unsigned long)i, arg);
+    }
+    AssertEqual(customLogger.lines.count, 0);
+    
+    CBLWarn(Database, @"Enabled log call for %@", arg);
+    AssertEqual(customLogger.lines.count, 1);
+}
+
+- (void) testAsynchronousLogging {
+    CustomLogger* customLogger = [[CustomLogger alloc] init];
+    customLogger.level = kCBLLogLevelInfo;
+    CBLDatabase.log.custom = customLogger;
+    CBLDatabase.log.asynchronous = YES;
+    Assert(CBLDatabase.log.asynchronous);
+    
+    uint64_t dropped = CBLDatabase.log.droppedMessageCount;
+    for (NSUInteger i = 0; i < 100; i++) {
+        CBLLogInfo(Database, @"Async message %lu", (unsigned long)i);
+    }
+    CBLLogVerbose(Database, @"IGNORE");
+    
+    // Messages are delivered on the log thread:
+    NSDate* timeout = [NSDate dateWithTimeIntervalSinceNow: 5.0];
+    while (customLogger.lines.count < 100 && [timeout timeIntervalSinceNow] > 0)
+        [NSThread sleepForTimeInterval: 0.01];
+    
+    NSArray* lines = customLogger.lines;
+    AssertEqual(lines.count, 100);
+    AssertEqual(CBLDatabase.log.droppedMessageCount, dropped);
+    for (NSUInteger i = 0; i < lines.count; i++) {
+        Assert([lines[i] containsString: ([NSString stringWithFormat: @"Async message %lu",
+                                           (unsigned long)i])]);
+    }
+    
+    CBLDatabase.log.asynchronous = NO;
+    [customLogger reset];
+    CBLLogInfo(Database, @"Sync message");
+    AssertEqual(customLogger.lines.count, 1);
+}
+
+- (void) testAsynchronousLoggingDropsMessages {
+    // A custom logger that blocks until the test lets it go:
+    dispatch_semaphore_t blocker = dispatch_semaphore_create(0);
+    __block NSUInteger received = 0;
+    [CBLDatabase.log setCustomLoggerWithLevel: kCBLLogLevelInfo
+                                   usingBlock: ^(CBLLogLevel level, CBLLogDomain domain,
+                                                 NSString* message)
+    {
+        if (received++ == 0)
+            dispatch_semaphore_wait(blocker, DISPATCH_TIME_FOREVER);
+    }];
+    CBLDatabase.log.asynchronous = YES;
+    
+    uint64_t dropped = CBLDatabase.log.droppedMessageCount;
+    CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+    for (NSUInteger i = 0; i < 10000; i++) {
+        CBLLogInfo(Database, @"Message %lu", (unsigned long)i);
+    }
+    CFAbsoluteTime elapsed = CFAbsoluteTimeGetCurrent() - start;
+    Log(@"Logged 10000 messages to a blocked logger in %.3f sec", elapsed);
+    
+    // The logging thread was never blocked; the overflow was dropped instead:
+    Assert(CBLDatabase.log.droppedMessageCount > dropped);
+    
+    dispatch_semaphore_signal(blocker);
+    CBLDatabase.log.asynchronous = NO;
+}
+
+- (void) testTracing {
+    AssertFalse(CBLDatabase.log.tracingEnabled);
+    CBLDatabase.log.tracingEnabled = YES;
+    Assert(CBLDatabase.log.tracingEnabled);
+    [self saveDocument: [self createDocument: @"traced"]];
+    CBLDatabase.log.tracingEnabled = NO;
+    
+    NSError* error;
+    NSDictionary* trace = [NSJSONSerialization JSONObjectWithData: [CBLDatabase.log exportTrace]
+                                                          options: 0
+                                                            error: &error];
+    AssertNotNil(trace, @"Invalid trace JSON: %@", error);
+    NSPredicate* save = [NSPredicate predicateWithFormat: @"name == 'Collection.save'"];
+    NSArray* events = [trace[@"traceEvents"] filteredArrayUsingPredicate: save];
+    Assert(events.count >= 2u);
+}
+
 #pragma clang diagnostic pop
 
 @end
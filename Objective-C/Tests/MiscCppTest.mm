@@ -18,7 +18,19 @@
 //
 
 #import "CBLTestCase.h"
+#import "CBLDocView.hh"
+#import "CBLFleece.hh"
 #import "CBLStatus.h"
+#import "CBLReplicatorMetrics+Internal.h"
+#import "CBLRingBuffer.hh"
+#import "CBLTrace.hh"
+#import "CBLWebSocketDeflate.hh"
+#import <string>
+#import <thread>
+#import <vector>
+#import <zlib.h>
+
+using namespace fleece;
 
 @interface MiscCppTest : CBLTestCase
 
@@ -96,4 +108,469 @@
     AssertEqual(c4Error.domain, FleeceDomain);
 }
 
+#pragma mark - WebSocket Compression
+
+// Builds a single WebSocket frame (payload shorter than 64KB):
+static std::vector<uint8_t> wsFrame(uint8_t firstByte, const std::string &payload,
+                                    const uint8_t* mask)
+{
+    std::vector<uint8_t> frame {firstByte};
+    uint8_t maskBit = mask ? 0x80 : 0;
+    if (payload.size() < 126) {
+        frame.push_back(maskBit | uint8_t(payload.size()));
+    } else {
+        frame.push_back(maskBit | 126);
+        frame.push_back(uint8_t(payload.size() >> 8));
+        frame.push_back(uint8_t(payload.size()));
+    }
+    if (mask)
+        frame.insert(frame.end(), mask, mask + 4);
+    for (size_t i = 0; i < payload.size(); ++i)
+        frame.push_back(uint8_t(payload[i]) ^ (mask ? mask[i & 3] : 0));
+    return frame;
+}
+
+// Compresses or decompresses a message payload the way a permessage-deflate peer would:
+static std::string zlibTransform(const std::string &input, bool compress) {
+    z_stream z {};
+    if (compress)
+        deflateInit2(&z, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+    else
+        inflateInit2(&z, -15);
+    std::string in = compress ? input : input + std::string("\x00\x00\xff\xff", 4);
+    std::string out(1 << 20, '\0');
+    z.next_in = (Bytef*)in.data();
+    z.avail_in = (uInt)in.size();
+    z.next_out = (Bytef*)&out[0];
+    z.avail_out = (uInt)out.size();
+    if (compress) {
+        deflate(&z, Z_SYNC_FLUSH);
+        out.resize(out.size() - z.avail_out - 4);   // strip the 00 00 FF FF trailer
+        deflateEnd(&z);
+    } else {
+        inflate(&z, Z_SYNC_FLUSH);
+        out.resize(out.size() - z.avail_out);
+        inflateEnd(&z);
+    }
+    return out;
+}
+
+static std::string repetitivePayload(size_t size) {
+    std::string payload;
+    while (payload.size() < size)
+        payload += "{\"name\":\"Couchbase Lite\",\"type\":\"sample\",\"tags\":[\"a\",\"b\"]}";
+    payload.resize(size);
+    return payload;
+}
+
+- (void) testWebSocketDeflateNegotiation {
+    cbl::WebSocketDeflate declined(0, 0);
+    AssertEqualObjects(declined.requestHeader(), @"permessage-deflate; client_max_window_bits");
+    Assert(declined.receivedResponseHeader(nil));
+    AssertFalse(declined.enabled());
+    
+    cbl::WebSocketDeflate accepted(12, 0);
+    Assert(accepted.receivedResponseHeader(@"permessage-deflate; client_max_window_bits=10; "
+                                           "server_no_context_takeover"));
+    Assert(accepted.enabled());
+    
+    cbl::WebSocketDeflate unknownExtension(0, 0);
+    AssertFalse(unknownExtension.receivedResponseHeader(@"x-webkit-deflate-frame"));
+    
+    cbl::WebSocketDeflate unknownParam(0, 0);
+    AssertFalse(unknownParam.receivedResponseHeader(@"permessage-deflate; foo=1"));
+    
+    cbl::WebSocketDeflate badWindow(0, 0);
+    AssertFalse(badWindow.receivedResponseHeader(@"permessage-deflate; server_max_window_bits=20"));
+}
+
+- (void) testWebSocketDeflateOutgoingFrames {
+    cbl::WebSocketDeflate deflate(0, 100);
+    Assert(deflate.receivedResponseHeader(@"permessage-deflate"));
+    const uint8_t mask[4] = {0x12, 0x34, 0x56, 0x78};
+    
+    // Below the threshold, the frame is sent as-is:
+    auto small = wsFrame(0x82, "hello", mask);
+    alloc_slice out;
+    Assert(deflate.encode(slice(small.data(), small.size()), out));
+    Assert(out == slice(small.data(), small.size()));
+    
+    // Large frame gets compressed, and RSV1 is set:
+    std::string payload = repetitivePayload(4000);
+    auto large = wsFrame(0x82, payload, mask);
+    Assert(deflate.encode(slice(large.data(), large.size()), out));
+    Assert(out.size < large.size() / 4);
+    auto bytes = (const uint8_t*)out.buf;
+    AssertEqual(bytes[0], 0x82 | 0x40);
+    AssertEqual(bytes[1] & 0x80, 0x80);
+    size_t length = bytes[1] & 0x7F, pos = 2;
+    if (length == 126) {
+        length = (bytes[2] << 8) | bytes[3];
+        pos = 4;
+    }
+    AssertEqual(memcmp(bytes + pos, mask, 4), 0);
+    pos += 4;
+    AssertEqual(pos + length, out.size);
+    std::string compressed((const char*)bytes + pos, length);
+    for (size_t i = 0; i < compressed.size(); ++i)
+        compressed[i] ^= mask[i & 3];
+    Assert(zlibTransform(compressed, false) == payload);
+    
+    // A frame split across writes is held back until it's complete:
+    Assert(deflate.encode(slice(large.data(), 100), out));
+    AssertEqual(out.size, 0u);
+    Assert(deflate.encode(slice(large.data() + 100, large.size() - 100), out));
+    AssertEqual(((const uint8_t*)out.buf)[0], 0x82 | 0x40);
+    AssertEqual(deflate.messageBytesSent(), 5 + 2 * payload.size());
+    Assert(deflate.wireBytesSent() < deflate.messageBytesSent() / 2);
+}
+
+- (void) testWebSocketDeflateIncomingFrames {
+    cbl::WebSocketDeflate deflate(0, 0);
+    Assert(deflate.receivedResponseHeader(@"permessage-deflate; server_no_context_takeover"));
+    
+    std::string payload = repetitivePayload(5000);
+    auto frame = wsFrame(0x82 | 0x40, zlibTransform(payload, true), nullptr);
+    auto ping = wsFrame(0x89, "ping", nullptr);
+    frame.insert(frame.end(), ping.begin(), ping.end());
+    
+    // Feed the frames in two chunks:
+    alloc_slice out;
+    Assert(deflate.decode(slice(frame.data(), 50), out));
+    AssertEqual(out.size, 0u);
+    Assert(deflate.decode(slice(frame.data() + 50, frame.size() - 50), out));
+    
+    auto expected = wsFrame(0x82, payload, nullptr);
+    expected.insert(expected.end(), ping.begin(), ping.end());
+    Assert(out == slice(expected.data(), expected.size()));
+    
+    // Uncompressed frames pass through:
+    auto plain = wsFrame(0x81, "plain text", nullptr);
+    Assert(deflate.decode(slice(plain.data(), plain.size()), out));
+    Assert(out == slice(plain.data(), plain.size()));
+    
+    // A compressed frame is rejected if the extension wasn't negotiated:
+    cbl::WebSocketDeflate declined(0, 0);
+    Assert(declined.receivedResponseHeader(nil));
+    auto compressed = wsFrame(0x82 | 0x40, zlibTransform(payload, true), nullptr);
+    AssertFalse(declined.decode(slice(compressed.data(), compressed.size()), out));
+}
+
+- (void) testWebSocketDeflateMaxMessageSize {
+    // 512KB of zeros compresses to well under 1KB:
+    std::string payload(512 * 1024, '\0');
+    std::string compressed = zlibTransform(payload, true);
+    Assert(compressed.size() < 1024);
+    auto frame = wsFrame(0x82 | 0x40, compressed, nullptr);
+    alloc_slice out;
+    
+    cbl::WebSocketDeflate deflate(0, 0, 64 * 1024);
+    Assert(deflate.receivedResponseHeader(@"permessage-deflate"));
+    AssertFalse(deflate.decode(slice(frame.data(), frame.size()), out));
+    
+    cbl::WebSocketDeflate roomy(0, 0, 1024 * 1024);
+    Assert(roomy.receivedResponseHeader(@"permessage-deflate"));
+    Assert(roomy.decode(slice(frame.data(), frame.size()), out));
+    AssertEqual(out.size, payload.size() + 10);        // 10-byte header with 64-bit length
+    
+    // The compressed message itself is limited too, even when split into fragments:
+    cbl::WebSocketDeflate tiny(0, 0, 100);
+    Assert(tiny.receivedResponseHeader(@"permessage-deflate"));
+    auto first = wsFrame(0x02 | 0x40, repetitivePayload(60), nullptr);
+    auto last = wsFrame(0x80, repetitivePayload(60), nullptr);
+    Assert(tiny.decode(slice(first.data(), first.size()), out));
+    AssertFalse(tiny.decode(slice(last.data(), last.size()), out));
+}
+
+- (void) testWebSocketMessageCounter {
+    const uint8_t mask[4] = {1, 2, 3, 4};
+    std::vector<uint8_t> frames;
+    for (auto &frame : {wsFrame(0x82, "first message", mask),          // complete message
+                        wsFrame(0x02, repetitivePayload(300), mask),   // first fragment
+                        wsFrame(0x89, "ping", nullptr),                // control frame
+                        wsFrame(0x80, repetitivePayload(1000), mask),  // last fragment
+                        wsFrame(0x81, "", nullptr)}) {                 // empty message
+        frames.insert(frames.end(), frame.begin(), frame.end());
+    }
+    
+    // The count doesn't depend on how the stream is split up:
+    for (size_t chunkSize : {1, 3, 100, 100000}) {
+        cbl::WebSocketMessageCounter counter;
+        size_t messages = 0;
+        for (size_t pos = 0; pos < frames.size(); pos += chunkSize) {
+            size_t size = std::min(chunkSize, frames.size() - pos);
+            messages += counter.count(slice(frames.data() + pos, size));
+        }
+        AssertEqual(messages, 3u);
+    }
+}
+
+#pragma mark - RingBuffer
+
+- (void) testRingBuffer {
+    cbl::RingBuffer<int> ring(5);
+    AssertEqual(ring.capacity(), 8u);
+    
+    int value;
+    AssertFalse(ring.pop(value));
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < 8; i++)
+            Assert(ring.push(i));
+        AssertFalse(ring.push(8));              // full
+        for (int i = 0; i < 8; i++) {
+            Assert(ring.pop(value));
+            AssertEqual(value, i);
+        }
+        AssertFalse(ring.pop(value));           // empty
+    }
+}
+
+- (void) testRingBufferConcurrent {
+    const int kProducers = 4, kItems = 100000;
+    cbl::RingBuffer<int64_t> ring(1024);
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; p++) {
+        producers.emplace_back([&] {
+            for (int64_t i = 1; i <= kItems; i++) {
+                while (!ring.push(i))
+                    std::this_thread::yield();
+            }
+        });
+    }
+    
+    int64_t sum = 0, count = 0, value;
+    while (count < kProducers * kItems) {
+        if (ring.pop(value)) {
+            sum += value;
+            count++;
+        }
+    }
+    for (auto &producer : producers)
+        producer.join();
+    
+    AssertEqual(sum, (int64_t)kProducers * kItems * (kItems + 1) / 2);
+    AssertFalse(ring.pop(value));
+}
+
+#pragma mark - Trace
+
+- (NSArray<NSDictionary*>*) exportedTraceEvents {
+    NSError* error;
+    NSDictionary* trace = [NSJSONSerialization JSONObjectWithData: cbl::exportChromeTrace()
+                                                          options: 0
+                                                            error: &error];
+    AssertNotNil(trace, @"Invalid trace JSON: %@", error);
+    NSPredicate* notMetadata = [NSPredicate predicateWithFormat: @"ph != 'M'"];
+    return [trace[@"traceEvents"] filteredArrayUsingPredicate: notMetadata];
+}
+
+- (void) testTrace {
+    cbl::resetTrace();
+    
+    // Nothing is recorded while disabled:
+    cbl::trace(cbl::TraceEvent::WebSocketRead, 100);
+    AssertEqual([self exportedTraceEvents].count, 0u);
+    
+    cbl::setTracingEnabled(true);
+    {
+        cbl::TraceSpan span(cbl::TraceEvent::QueryExecuteBegin, cbl::TraceEvent::QueryExecuteEnd);
+        span.setResult(1);
+    }
+    std::thread([] {
+        cbl::trace(cbl::TraceEvent::ReplicatorStatus, 3, 0);
+    }).join();
+    cbl::setTracingEnabled(false);
+    
+    NSArray<NSDictionary*>* events = [self exportedTraceEvents];
+    AssertEqual(events.count, 3u);
+    NSDictionary* begin = [events filteredArrayUsingPredicate:
+                           [NSPredicate predicateWithFormat: @"ph == 'B'"]].firstObject;
+    NSDictionary* end = [events filteredArrayUsingPredicate:
+                         [NSPredicate predicateWithFormat: @"ph == 'E'"]].firstObject;
+    NSDictionary* status = [events filteredArrayUsingPredicate:
+                            [NSPredicate predicateWithFormat: @"ph == 'i'"]].firstObject;
+    AssertEqualObjects(begin[@"name"], @"Query.execute");
+    AssertEqualObjects(end[@"name"], @"Query.execute");
+    AssertEqualObjects(end[@"args"][@"ok"], @1);
+    AssertEqualObjects(begin[@"tid"], end[@"tid"]);
+    Assert([end[@"ts"] doubleValue] >= [begin[@"ts"] doubleValue]);
+    AssertEqualObjects(status[@"name"], @"Replicator.status");
+    AssertEqualObjects(status[@"args"][@"level"], @3);
+    AssertFalse([status[@"tid"] isEqual: begin[@"tid"]]);
+    
+    cbl::resetTrace();
+    AssertEqual([self exportedTraceEvents].count, 0u);
+}
+
+- (void) testTraceReusesThreadSlots {
+    auto threadNameCount = [] {
+        NSDictionary* trace = [NSJSONSerialization JSONObjectWithData: cbl::exportChromeTrace()
+                                                              options: 0
+                                                                error: nullptr];
+        NSPredicate* metadata = [NSPredicate predicateWithFormat: @"ph == 'M'"];
+        return [trace[@"traceEvents"] filteredArrayUsingPredicate: metadata].count;
+    };
+    
+    // Threads that come and go one at a time take over the same ring and thread name slot:
+    cbl::setTracingEnabled(true);
+    std::thread([] { cbl::trace(cbl::TraceEvent::WebSocketRead, 1); }).join();
+    NSUInteger names = threadNameCount();
+    for (int i = 0; i < 100; i++)
+        std::thread([] { cbl::trace(cbl::TraceEvent::WebSocketRead, 1); }).join();
+    cbl::setTracingEnabled(false);
+    AssertEqual(threadNameCount(), names);
+    cbl::resetTrace();
+}
+
+- (void) testSharedKeyStrings {
+    cbl::SharedKeyStrings keyStrings;
+    NSString* name = keyStrings.get(5, "name"_sl);
+    AssertEqualObjects(name, @"name");
+    Assert(keyStrings.get(5, "name"_sl) == name);
+    
+    // The key was reassigned to a different string:
+    NSString* other = keyStrings.get(5, "other"_sl);
+    AssertEqualObjects(other, @"other");
+    Assert(keyStrings.get(5, "other"_sl) == other);
+    
+    // Out of range:
+    AssertNil(keyStrings.get(-1, "name"_sl));
+    AssertNil(keyStrings.get(2048, "name"_sl));
+}
+
+- (void) testDocumentKeysAreInterned {
+    for (NSString* docID in @[@"doc1", @"doc2"]) {
+        CBLMutableDocument* doc = [self createDocument: docID];
+        [doc setString: docID forKey: @"name"];
+        [self saveDocument: doc];
+    }
+    CBLCollection* collection = [self.db defaultCollection: nil];
+    NSString* key1 = [[collection documentWithID: @"doc1" error: nil] keys].firstObject;
+    NSString* key2 = [[collection documentWithID: @"doc2" error: nil] keys].firstObject;
+    AssertEqualObjects(key1, @"name");
+    Assert(key1 == key2);
+}
+
+- (void) testDocContextReuse {
+    // Keys with spaces aren't shared keys, so they're looked up in the context's string table.
+    // A context and its table are recycled when a document is released; the table mustn't return
+    // another document's strings, even if the Fleece data ends up at the same address.
+    const int kDocs = 100;
+    for (int i = 0; i < kDocs; i++) {
+        CBLMutableDocument* doc = [self createDocument: [NSString stringWithFormat: @"doc%d", i]];
+        [doc setValue: @{[NSString stringWithFormat: @"key %d", i]: @(i)} forKey: @"dict"];
+        [self saveDocument: doc];
+    }
+    CBLCollection* collection = [self.db defaultCollection: nil];
+    for (int i = 0; i < kDocs; i++) {
+        @autoreleasepool {
+            CBLDocument* doc = [collection documentWithID: [NSString stringWithFormat: @"doc%d", i]
+                                                    error: nil];
+            NSArray* keys = [doc dictionaryForKey: @"dict"].keys;
+            AssertEqualObjects(keys, (@[[NSString stringWithFormat: @"key %d", i]]));
+        }
+    }
+}
+
+namespace {
+    struct PersonSchema {
+        static constexpr std::array<slice, 5> kKeys {"name"_sl, "age"_sl, "height"_sl,
+                                                     "member"_sl, "address"_sl};
+        static constexpr cbl::Field<slice, 0>       name {};
+        static constexpr cbl::Field<int64_t, 1>     age {};
+        static constexpr cbl::Field<double, 2>      height {};
+        static constexpr cbl::Field<bool, 3>        member {};
+        static constexpr cbl::Field<Dict, 4>        address {};
+    };
+}
+
+- (CBLDocument*) savePersonDocument: (NSString*)docID {
+    CBLMutableDocument* mDoc = [self createDocument: docID];
+    [mDoc setString: @"Scott" forKey: @"name"];
+    [mDoc setInteger: 42 forKey: @"age"];
+    [mDoc setDouble: 1.85 forKey: @"height"];
+    [mDoc setBoolean: YES forKey: @"member"];
+    [mDoc setValue: @{@"city": @"Mountain View"} forKey: @"address"];
+    [self saveDocument: mDoc];
+    return [[self.db defaultCollection: nil] documentWithID: docID error: nil];
+}
+
+- (void) testDocView {
+    CBLDocument* doc = [self savePersonDocument: @"doc1"];
+    cbl::DocView<PersonSchema> person(doc);
+    Assert(person);
+    Assert(person[PersonSchema::name] == "Scott"_sl);
+    AssertEqual(person[PersonSchema::age], 42);
+    XCTAssertEqualWithAccuracy(person[PersonSchema::height], 1.85, 1e-9);
+    Assert(person[PersonSchema::member]);
+    Assert(person[PersonSchema::address]["city"_sl].asString() == "Mountain View"_sl);
+    
+    // No body:
+    cbl::DocView<PersonSchema> empty((FLDict)nullptr);
+    AssertFalse(empty);
+    AssertEqual(empty[PersonSchema::age], 0);
+    
+    CBLMutableDocument* mDoc = [self createDocument: @"doc2"];
+    [mDoc setString: @"Tiger" forKey: @"name"];
+    [self saveDocument: mDoc];
+    cbl::DocView<PersonSchema> partial([[self.db defaultCollection: nil] documentWithID: @"doc2"
+                                                                                 error: nil]);
+    Assert(partial.contains(PersonSchema::name));
+    AssertFalse(partial.contains(PersonSchema::age));
+    AssertEqual(partial[PersonSchema::age], 0);
+    Assert(partial[PersonSchema::address] == nullptr);
+}
+
+- (void) testDocViewOnDocumentMetadata {
+    [self savePersonDocument: @"doc1"];
+    
+    // The body of a document fetched with only its metadata is loaded by the view:
+    CBLDocument* doc = [[self.db defaultCollection: nil] documentMetadataWithID: @"doc1" error: nil];
+    AssertNotNil(doc);
+    cbl::DocView<PersonSchema> person(doc);
+    Assert(person);
+    Assert(person[PersonSchema::name] == "Scott"_sl);
+    AssertEqual(person[PersonSchema::age], 42);
+    AssertEqual([doc integerForKey: @"age"], 42);
+}
+
+- (void) testDocViewOnTwoDatabases {
+    CBLDocument* doc = [self savePersonDocument: @"doc1"];
+    
+    // Add the same keys to the other database's shared keys in the opposite order, one
+    // document at a time, so that each key gets a different number there:
+    [self openOtherDB];
+    CBLCollection* otherCollection = [self.otherDB defaultCollection: nil];
+    NSArray* keys = @[@"address", @"member", @"height", @"age", @"name"];
+    for (NSUInteger i = 0; i < keys.count; i++) {
+        CBLMutableDocument* mDoc = [self createDocument: [NSString stringWithFormat: @"key%lu",
+                                                          (unsigned long)i]];
+        [mDoc setInteger: (NSInteger)i forKey: keys[i]];
+        [self saveDocument: mDoc collection: otherCollection];
+    }
+    CBLMutableDocument* mDoc = [self createDocument: @"other"];
+    [mDoc setString: @"Tiger" forKey: @"name"];
+    [mDoc setInteger: 7 forKey: @"age"];
+    [mDoc setDouble: 0.9 forKey: @"height"];
+    [self saveDocument: mDoc collection: otherCollection];
+    CBLDocument* otherDoc = [otherCollection documentWithID: @"other" error: nil];
+    
+    // Alternate between the databases on the same thread:
+    for (int round = 0; round < 2; round++) {
+        cbl::DocView<PersonSchema> person(doc);
+        Assert(person[PersonSchema::name] == "Scott"_sl);
+        AssertEqual(person[PersonSchema::age], 42);
+        Assert(person[PersonSchema::member]);
+        
+        cbl::DocView<PersonSchema> other(otherDoc);
+        Assert(other[PersonSchema::name] == "Tiger"_sl);
+        AssertEqual(other[PersonSchema::age], 7);
+        XCTAssertEqualWithAccuracy(other[PersonSchema::height], 0.9, 1e-9);
+        AssertFalse(other.contains(PersonSchema::member));
+        
+        cbl::DocView<PersonSchema> otherBody(otherDoc.fleeceData);
+        AssertEqual(otherBody[PersonSchema::age], 7);
+    }
+}
+
 @end
@@ -72,6 +72,65 @@
     Assert(CBLParseISO8601Date("1970-01-01T00:00:00.123Z") - 0.123 < 0.0001);
 }
 
+#pragma mark - Format Date
+
+- (NSDateFormatter*) iso8601Formatter {
+    NSDateFormatter* formatter = [[NSDateFormatter alloc] init];
+    formatter.dateFormat = @"uuuu-MM-dd'T'HH:mm:ss.SSSXXX";
+    formatter.calendar = [[NSCalendar alloc] initWithCalendarIdentifier: NSCalendarIdentifierGregorian];
+    formatter.locale = [[NSLocale alloc] initWithLocaleIdentifier: @"en_US"];
+    formatter.timeZone = [NSTimeZone timeZoneForSecondsFromGMT: 0];
+    return formatter;
+}
+
+- (void) testJSONDateFormatMatchesDateFormatter {
+    NSDateFormatter* formatter = [self iso8601Formatter];
+    NSArray* timeZones = @[[NSTimeZone timeZoneForSecondsFromGMT: 0],
+                           [NSTimeZone timeZoneForSecondsFromGMT: -7 * 3600],
+                           [NSTimeZone timeZoneForSecondsFromGMT: 5 * 3600 + 1800],
+                           [NSTimeZone timeZoneWithName: @"America/Los_Angeles"]];
+    NSMutableArray* dates = [NSMutableArray arrayWithObjects:
+                             [NSDate dateWithTimeIntervalSince1970: 0],
+                             [NSDate dateWithTimeIntervalSince1970: -0.001],
+                             [NSDate dateWithTimeIntervalSince1970: 951782400],     // 2000-02-29
+                             [NSDate dateWithTimeIntervalSince1970: 1486318446.347],
+                             [NSDate dateWithTimeIntervalSince1970: 253402300799.999],
+                             [NSDate dateWithTimeIntervalSince1970: -12219292800], // 1582-10-15
+                             [NSDate dateWithTimeIntervalSince1970: -62135596800], // 0001-01-01
+                             nil];
+    for (int i = 0; i < 1000; i++) {
+        double t = ((double)arc4random() / UINT32_MAX) * 8.0e9 - 2.0e9;
+        [dates addObject: [NSDate dateWithTimeIntervalSince1970: t]];
+    }
+    
+    for (NSTimeZone* tz in timeZones) {
+        formatter.timeZone = tz;
+        for (NSDate* date in dates) {
+            AssertEqualObjects([CBLJSON JSONObjectWithDate: date timeZone: tz],
+                               [formatter stringFromDate: date]);
+        }
+    }
+}
+
+- (void) testJSONDateFormatConcurrently {
+    NSDateFormatter* formatter = [self iso8601Formatter];
+    NSMutableArray* dates = [NSMutableArray arrayWithCapacity: 100];
+    NSMutableArray* expected = [NSMutableArray arrayWithCapacity: 100];
+    for (NSUInteger i = 0; i < 100; i++) {
+        double t = ((double)arc4random() / UINT32_MAX) * 2.0e9;
+        NSDate* date = [NSDate dateWithTimeIntervalSince1970: t];
+        [dates addObject: date];
+        [expected addObject: [formatter stringFromDate: date]];
+    }
+    
+    // Four threads formatting at once; the timing is in DateFormatPerfTest:
+    dispatch_apply(4, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t n) {
+        for (NSUInteger i = 0; i < dates.count; i++) {
+            AssertEqualObjects([CBLJSON JSONObjectWithDate: dates[i]], expected[i]);
+        }
+    });
+}
+
 #pragma mark - CBLJSON
 
 - (void) testDataWithJSONObject {
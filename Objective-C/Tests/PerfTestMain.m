@@ -18,7 +18,10 @@
 //
 
 #import <CouchbaseLite/CouchbaseLite.h>
+#import "DateFormatPerfTest.h"
 #import "DocPerfTest.h"
+#import "DocViewPerfTest.h"
+#import "LogPerfTest.h"
 #import "TunesPerfTest.h"
 
 #define kDatabaseName @"perfdb"
@@ -34,7 +37,32 @@ int main(int argc, const char * argv[]) {
 
         NSLog(@"Starting test...");
         [DocPerfTest runWithConfig: config];
+        [DocViewPerfTest runWithConfig: config];
+        [LogPerfTest runWithConfig: config];
+        [DateFormatPerfTest runWithConfig: config];
         [TunesPerfTest runWithConfig: config];
+        
+        // Re-run the TuneMark with different database tuning settings:
+        CBLDatabaseConfiguration* ingest = [[CBLDatabaseConfiguration alloc] initWithConfig: config];
+        ingest.pageCacheSize = 32 * 1024 * 1024;
+        ingest.walAutoCheckpoint = 10000;
+        
+        CBLDatabaseConfiguration* reads = [[CBLDatabaseConfiguration alloc] initWithConfig: config];
+        reads.pageCacheSize = 32 * 1024 * 1024;
+        reads.mmapSize = 256 * 1024 * 1024;
+        
+        CBLDatabaseConfiguration* durable = [[CBLDatabaseConfiguration alloc] initWithConfig: config];
+        durable.fullSync = YES;
+        
+        NSDictionary<NSString*, CBLDatabaseConfiguration*>* matrix = @{
+            @"large cache, infrequent WAL checkpoints": ingest,
+            @"large cache, large mmap": reads,
+            @"full sync": durable,
+        };
+        for (NSString* name in matrix) {
+            NSLog(@"Starting TuneMark with %@...", name);
+            [TunesPerfTest runWithConfig: matrix[name]];
+        }
     }
     return 0;
 }
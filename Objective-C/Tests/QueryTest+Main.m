@@ -1628,6 +1628,34 @@
                 [[allObjects objectAtIndex: 4] valueForKey: @"id"]);
 }
 
+- (void) testQueryResultValueAtKeyPath {
+    [self loadJSONResource: @"names_100"];
+    
+    NSError* error;
+    CBLQuery* q = [self.db createQuery: @"SELECT name, contact FROM _ ORDER BY meta().id LIMIT 1"
+                                 error: &error];
+    Assert(q, @"Couldn't create query: %@", error);
+    CBLQueryResultSet* rs = [q execute: &error];
+    Assert(rs, @"Query failed: %@", error);
+    
+    CBLQueryResult* r = rs.allResults.firstObject;
+    AssertEqualObjects([r valueAtKeyPath: @"name.first"], @"Lue");
+    AssertEqualObjects([r valueAtKeyPath: @"contact.address.city"], @"San Pedro");
+    AssertEqualObjects([r valueAtKeyPath: @"contact.phone[-1]"], @"310-7618427");
+    AssertEqualObjects([r valueAtKeyPath: @"[0].last"], @"Laserna");
+    AssertEqualObjects([r valueAtKeyPath: @"[-1].email[0]"], @"lue.laserna@nosql-matters.org");
+    AssertEqualObjects([[r valueAtKeyPath: @"contact.address"] valueForKey: @"zip"], @"90732");
+    AssertEqualObjects([r valueAtKeyPath: @"contact"], [r valueForKey: @"contact"]);
+    AssertNil([r valueAtKeyPath: @"name.middle"]);
+    AssertNil([r valueAtKeyPath: @"nickname.first"]);
+    AssertNil([r valueAtKeyPath: @"[2].email"]);
+    AssertNil([r valueAtKeyPath: @"contact.phone[5]"]);
+    
+    CBLKeyPath* street = [CBLKeyPath keyPathWithString: @"contact.address.street" error: &error];
+    AssertNotNil(street, @"Couldn't compile key path: %@", error);
+    AssertEqualObjects([r valueAtCompiledKeyPath: street], @"19 Deer Loop");
+}
+
 #pragma mark - toJSON
 
 - (void) testQueryJSON {
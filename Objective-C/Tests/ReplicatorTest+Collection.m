@@ -1049,6 +1049,117 @@
     AssertEqual(col2b.count, 10);
 }
 
+- (void) testCollectionPushRevisionFilter {
+    NSError* error = nil;
+    CBLCollection* col1a = [self.db createCollectionWithName: @"colA"
+                                                       scope: @"scopeA" error: &error];
+    AssertNotNil(col1a);
+    AssertNil(error);
+    
+    CBLCollection* col1b = [self.db createCollectionWithName: @"colB"
+                                                       scope: @"scopeA" error: &error];
+    AssertNotNil(col1b);
+    AssertNil(error);
+    
+    CBLCollection* col2a = [self.otherDB createCollectionWithName: @"colA"
+                                                            scope: @"scopeA" error: &error];
+    AssertNotNil(col2a);
+    AssertNil(error);
+    
+    CBLCollection* col2b = [self.otherDB createCollectionWithName: @"colB"
+                                                            scope: @"scopeA" error: &error];
+    AssertNotNil(col2b);
+    AssertNil(error);
+    
+    // Create some documents in colA and colB of the database A.
+    [self createDocNumbered: col1a start: 0 num: 10];
+    [self createDocNumbered: col1b start: 10 num: 10];
+    
+    // Delete one document, which should be passed to the filter with the deleted flag:
+    CBLDocument* doc = [col1a documentWithID: @"doc9" error: &error];
+    Assert([col1a deleteDocument: doc error: &error]);
+    
+    id target = [[CBLDatabaseEndpoint alloc] initWithDatabase: self.otherDB];
+    CBLReplicatorConfiguration* config = [self configWithTarget: target
+                                                           type: kCBLReplicatorTypePush
+                                                     continuous: NO];
+    
+    __block NSInteger deletedCount = 0;
+    CBLCollectionConfiguration* colConfig = [[CBLCollectionConfiguration alloc] init];
+    colConfig.pushRevisionFilter = ^BOOL(CBLReplicatedRevision* revision) {
+        AssertNotNil(revision.revisionID);
+        if ((revision.flags & kCBLDocumentFlagsDeleted) == kCBLDocumentFlagsDeleted) {
+            deletedCount++;
+            AssertEqualObjects(revision.documentID, @"doc9");
+            Assert(![revision containsValueForKey: @"number1"]);
+            return NO;
+        }
+        
+        NSInteger number = [revision integerForKey: @"number1"];
+        AssertEqualObjects(revision.documentID, ([NSString stringWithFormat: @"doc%ld", (long)number]));
+        AssertEqualObjects([revision valueForKey: @"number1"], @(number));
+        AssertNil([revision stringForKey: @"number1"]);
+        if ([revision.collection.name isEqualToString: @"colA"])
+            return number < 5;
+        else
+            return number >= 15;
+    };
+    
+    [config addCollections: @[col1a, col1b] config: colConfig];
+    
+    [self run: config errorCode: 0 errorDomain: nil];
+    
+    AssertEqual(deletedCount, 1);
+    AssertEqual(col1a.count, 9);
+    AssertEqual(col1b.count, 10);
+    AssertEqual(col2a.count, 5);
+    AssertEqual(col2b.count, 5);
+}
+
+- (void) testCollectionPullRevisionFilterWithPullFilter {
+    NSError* error = nil;
+    CBLCollection* col1a = [self.db createCollectionWithName: @"colA"
+                                                       scope: @"scopeA" error: &error];
+    AssertNotNil(col1a);
+    AssertNil(error);
+    
+    CBLCollection* col2a = [self.otherDB createCollectionWithName: @"colA"
+                                                            scope: @"scopeA" error: &error];
+    AssertNotNil(col2a);
+    AssertNil(error);
+    
+    [self createDocNumbered: col2a start: 0 num: 10];
+    
+    id target = [[CBLDatabaseEndpoint alloc] initWithDatabase: self.otherDB];
+    CBLReplicatorConfiguration* config = [self configWithTarget: target
+                                                           type: kCBLReplicatorTypePull
+                                                     continuous: NO];
+    
+    // Only the documents accepted by both filters are pulled; the regular filter is only
+    // called for the documents accepted by the revision filter:
+    __block NSInteger filterCount = 0;
+    CBLCollectionConfiguration* colConfig = [[CBLCollectionConfiguration alloc] init];
+    colConfig.pullRevisionFilter = ^BOOL(CBLReplicatedRevision* revision) {
+        return [revision integerForKey: @"number1"] < 6;
+    };
+    colConfig.pullFilter = ^BOOL(CBLDocument* document, CBLDocumentFlags flags) {
+        filterCount++;
+        return [document integerForKey: @"number1"] % 2 == 0;
+    };
+    
+    [config addCollection: col1a config: colConfig];
+    
+    CBLCollectionConfiguration* copied = [config collectionConfig: col1a];
+    Assert(copied.pullRevisionFilter == colConfig.pullRevisionFilter);
+    AssertNil(copied.pushRevisionFilter);
+    
+    [self run: config errorCode: 0 errorDomain: nil];
+    
+    AssertEqual(filterCount, 6);
+    AssertEqual(col1a.count, 3);
+    AssertEqual(col2a.count, 10);
+}
+
 - (void) testCollectionDocumentIDsPushFilter {
     NSError* error = nil;
     CBLCollection* col1a = [self.db createCollectionWithName: @"colA"
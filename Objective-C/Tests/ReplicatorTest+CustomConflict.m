@@ -445,6 +445,70 @@
     AssertEqualObjects([self.db documentWithID: docId].toDictionary, exp);
 }
 
+- (void) testConflictResolverBatches {
+    NSUInteger n = 200;
+    NSError* error;
+    for (NSUInteger i = 0; i < n; i++) {
+        CBLMutableDocument* doc = [[CBLMutableDocument alloc] initWithID: $sprintf(@"doc%lu", (unsigned long)i)];
+        Assert([self.db saveDocument: doc error: &error]);
+    }
+    [self run: [self config: kCBLReplicatorTypePush] errorCode: 0 errorDomain: nil];
+    
+    for (NSUInteger i = 0; i < n; i++) {
+        NSString* docID = $sprintf(@"doc%lu", (unsigned long)i);
+        CBLMutableDocument* doc1 = [[self.db documentWithID: docID] toMutable];
+        [doc1 setString: @"local" forKey: @"key"];
+        Assert([self.db saveDocument: doc1 error: &error]);
+        
+        CBLMutableDocument* doc2 = [[self.otherDB documentWithID: docID] toMutable];
+        [doc2 setString: @"remote" forKey: @"key"];
+        Assert([self.otherDB saveDocument: doc2 error: &error]);
+    }
+    
+    __block NSUInteger count = 0;
+    TestConflictResolver* resolver;
+    resolver = [[TestConflictResolver alloc] initWithResolver: ^CBLDocument* (CBLConflict* con) {
+        @synchronized (self) {
+            count++;
+        }
+        return con.remoteDocument;
+    }];
+    
+    CBLReplicatorConfiguration* config = [self config: kCBLReplicatorTypePull];
+    config.conflictResolver = resolver;
+    config.maxConflictResolvers = 2;
+    config.conflictResolutionBatchSize = 20;
+    
+    __block id<CBLListenerToken> token;
+    __block CBLReplicator* replicator;
+    NSMutableSet<NSString*>* docIDs = [NSMutableSet set];
+    [self run: config reset: NO errorCode: 0 errorDomain: nil onReplicatorReady: ^(CBLReplicator* r) {
+        replicator = r;
+        token = [r addDocumentReplicationListener: ^(CBLDocumentReplication* docRepl) {
+            @synchronized (docIDs) {
+                for (CBLReplicatedDocument* replDoc in docRepl.documents) {
+                    AssertNil(replDoc.error);
+                    [docIDs addObject: replDoc.id];
+                }
+            }
+        }];
+    }];
+    [replicator removeChangeListenerWithToken: token];
+    
+    AssertEqual(count, n);
+    AssertEqual(docIDs.count, n);
+    
+    CBLConflictResolutionStats stats = replicator.conflictResolutionStats;
+    AssertEqual(stats.resolved, n);
+    AssertEqual(stats.failed, 0u);
+    Assert(stats.batches >= n / 20);
+    
+    for (NSUInteger i = 0; i < n; i++) {
+        CBLDocument* doc = [self.db documentWithID: $sprintf(@"doc%lu", (unsigned long)i)];
+        AssertEqualObjects([doc stringForKey: @"key"], @"remote");
+    }
+}
+
 -  (void) testConflictResolverWrongDocID {
     // Enable Logging to check whether the logs are printing
     CustomLogger* custom = [[CustomLogger alloc] init];
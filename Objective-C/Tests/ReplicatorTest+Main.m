@@ -882,6 +882,118 @@
     [replicator removeChangeListenerWithToken: token];
 }
 
+- (void) testDocumentReplicationSummary {
+    NSError* error;
+    for (NSUInteger i = 1; i <= 3; i++) {
+        CBLMutableDocument* doc = [[CBLMutableDocument alloc] initWithID: $sprintf(@"doc%lu", (unsigned long)i)];
+        [doc setString: @"Tiger" forKey: @"species"];
+        Assert([self.db saveDocument: doc error: &error]);
+    }
+    
+    // Create a conflict for doc2 in the other database:
+    CBLMutableDocument* doc2b = [[CBLMutableDocument alloc] initWithID: @"doc2"];
+    [doc2b setString: @"Lion" forKey: @"species"];
+    Assert([self.otherDB saveDocument: doc2b error: &error]);
+    
+    // Push:
+    id target = [[CBLDatabaseEndpoint alloc] initWithDatabase: self.otherDB];
+    id config = [self configWithTarget: target type: kCBLReplicatorTypePush continuous: NO];
+    
+    __block id<CBLListenerToken> token;
+    __block CBLReplicator* replicator;
+    __block NSUInteger count = 0;
+    NSMutableArray<CBLReplicatedDocument*>* failedDocs = [NSMutableArray array];
+    [self run: config reset: NO errorCode: 0 errorDomain: nil onReplicatorReady: ^(CBLReplicator* r) {
+        replicator = r;
+        token = [r addDocumentReplicationSummaryListener: ^(CBLDocumentReplicationSummary* summary) {
+            Assert(summary.isPush);
+            AssertEqual(summary.replicator, replicator);
+            count += summary.documentCount;
+            [failedDocs addObjectsFromArray: summary.failedDocuments];
+        }];
+    }];
+    
+    AssertEqual(count, 3u);
+    AssertEqual(failedDocs.count, 1u);
+    AssertEqualObjects(failedDocs[0].id, @"doc2");
+    AssertEqualObjects(failedDocs[0].error.domain, CBLErrorDomain);
+    AssertEqual(failedDocs[0].error.code, CBLErrorHTTPConflict);
+    
+    // Remove the listener:
+    [replicator removeChangeListenerWithToken: token];
+    
+    CBLMutableDocument* doc4 = [[CBLMutableDocument alloc] initWithID: @"doc4"];
+    Assert([self.db saveDocument: doc4 error: &error]);
+    
+    // Run the replicator again, and check that no summary was posted:
+    [self runWithReplicator: replicator errorCode: 0 errorDomain: 0];
+    AssertEqual(count, 3u);
+    AssertEqual(self.otherDB.count, 4u);
+}
+
+- (void) testReplicatorMetrics {
+    NSError* error;
+    for (NSUInteger i = 0; i < 10; i++) {
+        CBLMutableDocument* doc = [[CBLMutableDocument alloc] initWithID: $sprintf(@"doc%lu", (unsigned long)i)];
+        [doc setInteger: i forKey: @"number"];
+        Assert([self.db saveDocument: doc error: &error]);
+    }
+    for (NSUInteger i = 0; i < 5; i++) {
+        CBLMutableDocument* doc = [[CBLMutableDocument alloc] initWithID: $sprintf(@"other%lu", (unsigned long)i)];
+        Assert([self.otherDB saveDocument: doc error: &error]);
+    }
+    
+    id target = [[CBLDatabaseEndpoint alloc] initWithDatabase: self.otherDB];
+    CBLReplicatorConfiguration* config = [self configWithTarget: target
+                                                           type: kCBLReplicatorTypePushAndPull
+                                                     continuous: NO];
+    config.pushFilter = ^BOOL(CBLDocument* document, CBLDocumentFlags flags) {
+        return [document integerForKey: @"number"] < 8;
+    };
+    
+    __block CBLReplicator* replicator;
+    [self run: config reset: NO errorCode: 0 errorDomain: nil onReplicatorReady: ^(CBLReplicator* r) {
+        replicator = r;
+        CBLReplicatorMetrics* metrics = r.metrics;
+        AssertEqual(metrics.documentsPushed, 0u);
+        AssertEqual(metrics.activeTime, 0.0);
+        AssertFalse(r.documentMetricsEnabled);
+        r.documentMetricsEnabled = YES;
+    }];
+    
+    // No document replication listener is needed for the document counts:
+    CBLReplicatorMetrics* metrics = replicator.metrics;
+    AssertEqual(metrics.documentsPushed, 8u);
+    AssertEqual(metrics.documentsPulled, 5u);
+    AssertEqual(metrics.documentErrors, 0u);
+    AssertEqual(metrics.filterCalls, 10u);
+    Assert(metrics.filterTime > 0);
+    Assert(metrics.activeTime > 0);
+    Assert(metrics.pushRate > 0);
+    Assert(metrics.pullRate > 0);
+    AssertEqual(metrics.conflictsResolved, 0u);
+    
+    // A local database endpoint doesn't use a WebSocket:
+    AssertEqual(metrics.bytesSent, 0u);
+    AssertEqual(metrics.roundTripTime, 0.0);
+    
+    // The metrics accumulate across runs:
+    CBLMutableDocument* doc = [[CBLMutableDocument alloc] initWithID: @"doc10"];
+    Assert([self.db saveDocument: doc error: &error]);
+    [self runWithReplicator: replicator errorCode: 0 errorDomain: 0];
+    AssertEqual(replicator.metrics.documentsPushed, 9u);
+    AssertEqual(replicator.metrics.filterCalls, 11u);
+    Assert(replicator.metrics.activeTime > metrics.activeTime);
+    
+    // Without document counting, the other metrics are still collected:
+    replicator.documentMetricsEnabled = NO;
+    doc = [[CBLMutableDocument alloc] initWithID: @"doc11"];
+    Assert([self.db saveDocument: doc error: &error]);
+    [self runWithReplicator: replicator errorCode: 0 errorDomain: 0];
+    AssertEqual(replicator.metrics.documentsPushed, 9u);
+    AssertEqual(replicator.metrics.filterCalls, 12u);
+}
+
 - (void) testDocumentReplicationEventWithPullConflict {
     NSError* error;
     CBLMutableDocument* doc1a = [[CBLMutableDocument alloc] initWithID: @"doc1"];
@@ -1620,6 +1732,28 @@
     [self run: config errorCode: 0 errorDomain: nil];
 }
 
+- (void) testReplicatorMetrics_SG {
+    id target = [self remoteEndpointWithName: @"scratch" secure: NO];
+    if (!target)
+        return;
+    
+    [self eraseRemoteEndpoint: target];
+    [self createDocNumbered: nil start: 0 num: 100];
+    
+    id config = [self configWithTarget: target type: kCBLReplicatorTypePush continuous: NO];
+    [self run: config errorCode: 0 errorDomain: nil];
+    
+    CBLReplicatorMetrics* metrics = repl.metrics;
+    Log(@"**** %@", metrics);
+    AssertEqual(metrics.documentsPushed, 100u);
+    Assert(metrics.bytesSent > 0);
+    Assert(metrics.bytesReceived > 0);
+    Assert(metrics.messagesSent > 0);
+    Assert(metrics.messagesReceived > 0);
+    Assert(metrics.revisionsPerMessage > 0);
+    Assert(metrics.roundTripTime > 0);
+}
+
 - (void) dontTestMissingHost_SG {
     // Note: The replication doesn't fail with an error; because the unknown-host error is
     // considered transient, the replicator just stays offline and waits for a network change.
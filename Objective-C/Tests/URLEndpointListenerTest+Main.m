@@ -19,6 +19,7 @@
 
 #import "URLEndpointListenerTest.h"
 #import "CollectionUtils.h"
+#import <sys/resource.h>
 
 @interface URLEndpointListenerTest_Main : URLEndpointListenerTest
 @end
@@ -865,6 +866,56 @@
     }
 }
 
+// Compares bytes on the wire and CPU time of a pull with and without permessage-deflate.
+- (void) testWebSocketCompressionBenchmark {
+    // Documents with typical JSON content on the listener side:
+    const NSUInteger kNumDocs = 2000;
+    NSError* error;
+    Assert([self.otherDB inBatch: &error usingBlock: ^{
+        for (NSUInteger i = 0; i < kNumDocs; i++) {
+            CBLMutableDocument* doc = [self createDocument: $sprintf(@"doc-%lu", (unsigned long)i)];
+            [doc setString: @"Couchbase Lite replication compression benchmark" forKey: @"title"];
+            [doc setString: [self randomStringWithLength: 64] forKey: @"token"];
+            [doc setArray: [[CBLMutableArray alloc] initWithData: @[@"red", @"green", @"blue"]]
+                   forKey: @"colors"];
+            [doc setInteger: (NSInteger)i forKey: @"index"];
+            NSError* err;
+            Assert([self.otherDB saveDocument: doc error: &err], @"Failed to save %@", err);
+        }
+    }], @"Error: %@", error);
+    
+    [self listenWithTLS: NO];
+    
+    double uncompressedMB = 0;
+    for (int compress = 0; compress <= 1; compress++) {
+        [self cleanDB];
+        CBLReplicatorConfiguration* pull = [self configWithTarget: _listener.localEndpoint
+                                                             type: kCBLReplicatorTypePull
+                                                       continuous: NO];
+        pull.webSocketCompression = (compress == 1);
+        
+        struct rusage usage0, usage1;
+        getrusage(RUSAGE_SELF, &usage0);
+        [self run: pull errorCode: 0 errorDomain: nil];
+        getrusage(RUSAGE_SELF, &usage1);
+        AssertEqual(self.db.count, kNumDocs);
+        CBLReplicatorMetrics* metrics = repl.metrics;
+        
+        // Both ends run in this process, so the CPU time includes the listener's side.
+        double cpu = (usage1.ru_utime.tv_sec - usage0.ru_utime.tv_sec)
+                   + (usage1.ru_stime.tv_sec - usage0.ru_stime.tv_sec)
+                   + (usage1.ru_utime.tv_usec - usage0.ru_utime.tv_usec) / 1.0e6
+                   + (usage1.ru_stime.tv_usec - usage0.ru_stime.tv_usec) / 1.0e6;
+        double wireMB = (metrics.bytesReceived + metrics.bytesSent) / (1024.0 * 1024.0);
+        if (!compress)
+            uncompressedMB = wireMB;
+        Log(@"**** Pull %s compression: %.2f MB on wire, %.0f ms CPU, %.1f ms CPU per MB of data",
+            (compress ? "with" : "without"), wireMB, cpu * 1000.0, cpu * 1000.0 / uncompressedMB);
+    }
+    
+    [self stopListen];
+}
+
 - (void) testMultipleListenersOnSameDatabase {
     if (!self.keyChainAccessAllowed) return;
     
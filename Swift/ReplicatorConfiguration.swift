@@ -248,6 +248,21 @@ public struct ReplicatorConfiguration {
     /// they will not receive the events.
     public var enableAutoPurge: Bool = true
     
+    /// Compresses the WebSocket messages with the permessage-deflate extension (RFC 7692), if the
+    /// server accepts it. This reduces the bytes sent over the network at the cost of some CPU time.
+    /// The default value is false.
+    public var webSocketCompression: Bool = false
+    
+    /// The size of the LZ77 window, as a power of two from 9 to 15, used to compress outgoing
+    /// messages when webSocketCompression is enabled. Values outside the range are clamped to it.
+    /// Set the value to zero (by default) to use the default of 15.
+    public var webSocketCompressionWindowBits: UInt = 0
+    
+    /// The size in bytes below which outgoing messages are sent uncompressed when
+    /// webSocketCompression is enabled. Set the value to zero (by default) to use the default
+    /// of 256 bytes.
+    public var webSocketCompressionThreshold: UInt = 0
+    
     /// The collections used for the replication.
     public var collections: [Collection] {
         return Array(self.collectionConfigs.keys)
@@ -367,6 +382,9 @@ public struct ReplicatorConfiguration {
         self.maxAttempts = config.maxAttempts
         self.maxAttemptWaitTime = config.maxAttemptWaitTime
         self.enableAutoPurge = config.enableAutoPurge
+        self.webSocketCompression = config.webSocketCompression
+        self.webSocketCompressionWindowBits = config.webSocketCompressionWindowBits
+        self.webSocketCompressionThreshold = config.webSocketCompressionThreshold
         
         for (col, config) in config.collectionConfigs {
             if !col.isValid {
@@ -428,6 +446,9 @@ public struct ReplicatorConfiguration {
         c.maxAttempts = self.maxAttempts
         c.maxAttemptWaitTime = self.maxAttemptWaitTime
         c.enableAutoPurge = self.enableAutoPurge
+        c.webSocketCompression = self.webSocketCompression
+        c.webSocketCompressionWindowBits = self.webSocketCompressionWindowBits
+        c.webSocketCompressionThreshold = self.webSocketCompressionThreshold
         
         for (col, config) in self.collectionConfigs {
             if !col.isValid {